@@ -0,0 +1,57 @@
+/** @file BatchPipeline.h
+ *  @brief Processes a directory of PPM images on a thread pool
+ *
+ *  Every image in the input directory is loaded, run through a chain
+ *  of pixel operations and saved to the output directory. Images are
+ *  handled concurrently, and each image is also split into bands of
+ *  rows so a single large image is spread over all cores.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef BATCHPIPELINE_H
+#define BATCHPIPELINE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "PPM.h"
+
+// One step of a pipeline, applied to a band of packed R,G,B pixels
+struct BatchOperation {
+  std::string name;
+  std::function<void(unsigned char *rgb, std::size_t pixelCount)> apply;
+};
+
+// Settings for one batch run
+struct BatchOptions {
+  std::string inputDirectory;
+  std::string outputDirectory;
+  std::vector<BatchOperation> operations;
+  PPM::Format outputFormat{ PPM::P3 };
+  // 0 uses one thread per hardware core
+  unsigned int threadCount{ 0 };
+};
+
+// Turns an operation name into a BatchOperation. Accepted names are
+// darken, brighten, invert, grayscale and threshold[=level].
+// Returns false for an unknown name.
+bool parseBatchOperation(const std::string &text, BatchOperation &operation);
+
+// Processes every .ppm file in the input directory and prints the
+// throughput of each stage. Returns the number of images that failed.
+int runBatch(const BatchOptions &options);
+
+// Entry point for the --batch command line mode:
+//   --batch <inputDir> <outputDir> [--threads N] [--format P3|P5|P6] <operation>...
+// Returns the process exit code.
+int runBatchCommand(int argc, char **argv);
+
+// Entry point for the --stream command line mode, which filters one
+// image band by band with bounded memory (see PPMStream.h):
+//   --stream <input.ppm> <output.ppm> [--band-rows N] [--format P3|P5|P6] <operation>...
+// Returns the process exit code.
+int runStreamCommand(int argc, char **argv);
+
+#endif
@@ -0,0 +1,88 @@
+/** @file Convolution.h
+ *  @brief CPU convolution of packed R,G,B images
+ *
+ *  The same 3x3 post-processing kernels as Lab10's FBOFrag.glsl
+ *  (sharpen, blur) plus Gaussian, box and Sobel filters, for use on
+ *  PPM pixel buffers offline. convolve() picks the cheapest method
+ *  for the kernel it is given:
+ *
+ *  - Box kernels (all weights equal) use running sums, so the cost
+ *    per pixel does not depend on the radius.
+ *  - Separable kernels (an outer product of a column and a row, as
+ *    Gaussian and Sobel kernels are) run as two 1D passes, costing
+ *    2 * (2r + 1) multiplies per value instead of (2r + 1)^2.
+ *  - Anything else (such as sharpen) runs as a direct 2D sum.
+ *
+ *  The 1D passes are vectorized across each row, and rows are split
+ *  into bands over a ThreadPool when one is given. Pixels outside the
+ *  image repeat the nearest edge pixel (like GL_CLAMP_TO_EDGE).
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <vector>
+
+class ThreadPool;
+
+namespace Convolution {
+
+// A square (2 * radius + 1)^2 kernel, weights stored row by row
+struct Kernel {
+  int radius{ 0 };
+  std::vector<float> weights;
+
+  inline int size() const { return (2 * radius) + 1; }
+  // Weight at column x, row y (both 0 to size() - 1)
+  inline float at(int x, int y) const { return weights[(y * size()) + x]; }
+};
+
+// How convolve() filters an image
+enum Method {
+  // Fastest method the kernel allows
+  Automatic,
+  // Direct 2D sum over every weight
+  Naive,
+  // Two 1D passes; needs a separable kernel
+  Separable,
+  // Running sums; needs a box kernel
+  Box
+};
+
+// Builds a kernel from (2 * radius + 1)^2 weights given row by row
+Kernel makeKernel(int radius, const std::vector<float> &weights);
+// Averages every pixel within radius
+Kernel boxKernel(int radius);
+// Normalized Gaussian. A sigma of 0 or less uses radius / 2.
+Kernel gaussianKernel(int radius, float sigma = 0.0f);
+// The 3x3 sharpen kernel from FBOFrag.glsl
+Kernel sharpenKernel();
+// The 3x3 blur kernel from FBOFrag.glsl (1 2 1 / 2 4 2 / 1 2 1, over 16)
+Kernel blurKernel();
+// Horizontal and vertical 3x3 Sobel gradients
+Kernel sobelXKernel();
+Kernel sobelYKernel();
+
+// Returns true if every weight of the kernel is the same
+bool isBox(const Kernel &kernel);
+// Splits a separable kernel into the column and row whose outer
+// product it is. Returns false if the kernel is not separable.
+bool separate(const Kernel &kernel, std::vector<float> &column, std::vector<float> &row);
+
+// Filters a width x height packed R,G,B image from src into dst (which
+// must not overlap src). Results are rounded and clamped to 0-255.
+// A method the kernel does not allow falls back to Naive. Rows are
+// spread over pool when it is not null.
+void convolve(const unsigned char *src, unsigned char *dst, int width, int height,
+  const Kernel &kernel, ThreadPool *pool = nullptr, Method method = Automatic);
+
+// Writes the Sobel gradient magnitude of each channel of src to dst,
+// clamped to 0-255
+void sobel(const unsigned char *src, unsigned char *dst, int width, int height,
+  ThreadPool *pool = nullptr);
+
+} // namespace Convolution
+
+#endif
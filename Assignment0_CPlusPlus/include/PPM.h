@@ -1,7 +1,9 @@
 /** @file PPM.h
  *  @brief Class for working with PPM images
  *
- *  Class for working with P3 PPM images specifically.
+ *  Class for working with PPM images. Plain (P3) and binary (P6)
+ *  color images as well as binary grayscale (P5) images can be
+ *  loaded and saved. Pixels are always stored as 8-bit R,G,B.
  *
  *  @author your_name_here
  *  @bug No known bugs.
@@ -9,51 +11,101 @@
 #ifndef PPM_H
 #define PPM_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
+#include "Convolution.h"
+#include "PixelBuffer.h"
+
+class ThreadPool;
 
 class PPM {
 public:
+  // File formats a PPM can be saved as
+  enum Format {
+    P3, // Plain text RGB
+    P5, // Binary grayscale
+    P6  // Binary RGB
+  };
+
+  // Creates an empty image
+  PPM() = default;
   // Constructor loads a filename with the .ppm extension
   PPM(std::string fileName);
-  // Destructor clears any memory that has been allocated
-  ~PPM();
+  // Copies are deep; moves take over the pixel data and
+  // leave the source empty. Memory is released automatically.
+  PPM(const PPM &other) = default;
+  PPM &operator=(const PPM &other) = default;
+  PPM(PPM &&other) noexcept;
+  PPM &operator=(PPM &&other) noexcept;
+  // Replaces the image with the one in fileName. The existing pixel
+  // memory is reused when it is large enough, so cycling through
+  // images of similar size does not allocate. Returns false (and
+  // leaves the image empty) if the file could not be loaded.
+  bool reload(const std::string &fileName);
   // Saves a PPM Image to a new file.
-  void savePPM(std::string outputFileName);
+  // P3 is the default; P5 and P6 are much smaller and faster to load.
+  // Returns false if the file could not be written.
+  bool savePPM(std::string outputFileName, Format format = P3);
   // Darken subtracts 50 from each of the red, green
   // and blue color components of all of the pixels
   // in the PPM. Note that no values may be less than
   // 0 in a ppm.
   void darken();
+  // The darken filter on its own, for any span of R,G,B pixels
+  // (for example one band of rows from a PPMReader)
+  static void darkenPixels(unsigned char *rgb, std::size_t pixelCount);
+  // Brighten adds 50 to each color component, without
+  // letting any value go above 255.
+  void brighten();
+  // Inverts each color component (255 - value)
+  void invert();
+  // Replaces each pixel with its luminance
+  void grayscale();
+  // Sets each color component at or above level to 255
+  // and all others to 0
+  void threshold(unsigned char level);
+  // Maps each color component through a 256-entry table per channel
+  void applyLUT(const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB);
+  // Filters the image with a convolution kernel, such as
+  // Convolution::gaussianKernel(radius) or Convolution::sharpenKernel().
+  // Rows are spread over pool when one is given.
+  void convolve(const Convolution::Kernel &kernel, ThreadPool *pool = nullptr);
+  // Replaces each color component with its Sobel edge strength
+  void detectEdges(ThreadPool *pool = nullptr);
   // Sets a pixel to a specific R,G,B value 
   void setPixel(int x, int y, int r, int g, int b);
 
+  // Returns true if an image was loaded successfully
+  inline bool isLoaded() const { return !m_pixels.empty(); }
   // Returns the raw pixel data in an array.
-  inline unsigned char *pixelData() { return m_PixelData; }
+  // The array is aligned to PixelBuffer::ALIGNMENT bytes.
+  inline unsigned char *pixelData() { return m_pixels.data(); }
   // Returns image width
   inline int getWidth() { return m_width; }
   // Returns image height
   inline int getHeight() { return m_height; }
 private:
-  // Parses a PPM file and saves its color values
-  void parsePPMFile(std::ifstream &inFile);
-  // Use a token from the first part of the PPM file to set the width,
-  // height (and initial pixel data), or max color value
-  void parseMetadata(std::string token, int i, int &colorScale);
-  // Use a token from the body of the PPM file to store an individual
-  // color value, or save a pixel if we are at the end of a triple
-  void parseColorValues(std::string token, int i, int colorScale,
-    int &r, int &g, unsigned int &x, unsigned int &y);
-  // Subtracts 50 from an individual color component,
-  // without making it go below 0
-  int darkenColor(int colorValue);
+  // Parses the contents of a PPM file (header and body in one pass)
+  // and saves its color values
+  bool parsePPMFile(const char *data, std::size_t size);
+  // Reads the decimal color values of a P3 body
+  bool parsePlainBody(const char *p, const char *end,
+    const std::vector<unsigned char> &colorScale);
+  // Reads the binary raster of a P5 or P6 body (8 or 16 bits per sample)
+  bool parseRawBody(const char *p, const char *end, int channels, int maxValue,
+    const std::vector<unsigned char> &colorScale);
+  // Saves the image as a binary P5 or P6 file
+  bool saveRawPPM(const std::string &outputFileName, Format format);
+  // Number of bytes of pixel data (3 per pixel)
+  std::size_t pixelByteCount() const;
   // Calculates the index of the R color component in the
   // pixel data based on pixel's x and y coordinates
   int getRIndex(int x, int y);
 
   // Store the raw pixel data here
   // Data is R,G,B format
-  unsigned char *m_PixelData;
+  PixelBuffer m_pixels;
   // Store width and height of image
   int m_width{ 0 };
   int m_height{ 0 };
@@ -0,0 +1,145 @@
+/** @file PPMFormat.h
+ *  @brief Low-level helpers shared by the PPM readers and writers
+ *
+ *  Tokenizing of the plain text parts of a PPM, conversion of binary
+ *  samples to 8-bit R,G,B, and the pre-rendered decimal text used to
+ *  write P3 bodies. Used by both the whole-image PPM class and the
+ *  streaming reader/writer.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef PPMFORMAT_H
+#define PPMFORMAT_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace PPMFormat {
+
+// Largest value of an 8-bit color component
+const int MAX_COLOR_VALUE = 255;
+// Largest max color value allowed in a PPM header (16-bit samples)
+const int MAX_WIDE_COLOR_VALUE = 65535;
+
+inline bool isDigit(char c) {
+  return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+// Advances p past any whitespace and '#' comments (a comment runs
+// to the end of its line)
+inline void skipWhitespaceAndComments(const char *&p, const char *end) {
+  while (p < end) {
+    if (*p == '#') {
+      while (p < end && *p != '\n') ++p;
+    }
+    else if (isSpace(*p)) {
+      ++p;
+    }
+    else {
+      break;
+    }
+  }
+}
+
+// Scans the next unsigned decimal integer, skipping any whitespace
+// and comments in front of it. Returns false if there is no integer.
+// Values too large for an int saturate at 999999999.
+inline bool scanInt(const char *&p, const char *end, int &value) {
+  skipWhitespaceAndComments(p, end);
+  if (p == end || !isDigit(*p)) return false;
+  int result = 0;
+  do {
+    result = (result < 100000000) ? (result * 10) + (*p - '0') : 999999999;
+    ++p;
+  } while (p < end && isDigit(*p));
+  value = result;
+  return true;
+}
+
+// Table mapping every value up to maxValue onto 0-255
+inline std::vector<unsigned char> makeColorScale(int maxValue) {
+  std::vector<unsigned char> colorScale(maxValue + 1);
+  for (int value = 0; value <= maxValue; ++value) {
+    colorScale[value] = static_cast<unsigned char>(
+      ((value * MAX_COLOR_VALUE) + (maxValue / 2)) / maxValue);
+  }
+  return colorScale;
+}
+
+// Converts pixelCount binary P5 (1 channel) or P6 (3 channel) pixels
+// to 8-bit R,G,B. Samples are one byte each, or two big-endian bytes
+// when maxValue > 255. Grayscale is copied to all three channels.
+inline void convertRawSamples(const unsigned char *in, std::size_t pixelCount, int channels,
+  int maxValue, const std::vector<unsigned char> &colorScale, unsigned char *rgb) {
+  // The common case: 8-bit RGB is already in our layout
+  if (channels == 3 && maxValue == MAX_COLOR_VALUE) {
+    std::memcpy(rgb, in, pixelCount * 3);
+    return;
+  }
+
+  const std::size_t sampleCount = pixelCount * channels;
+  const unsigned char *scale = colorScale.data();
+  for (std::size_t i = 0; i < sampleCount; ++i) {
+    int value = (maxValue > MAX_COLOR_VALUE) ? (in[2 * i] << 8) | in[(2 * i) + 1] : in[i];
+    unsigned char color = scale[value < maxValue ? value : maxValue];
+    if (channels == 1) {
+      rgb[(i * 3)] = color;
+      rgb[(i * 3) + 1] = color;
+      rgb[(i * 3) + 2] = color;
+    }
+    else {
+      rgb[i] = color;
+    }
+  }
+}
+
+// A color value rendered as decimal text followed by a space
+struct DecimalText {
+  char digits[4];
+  std::size_t length;
+};
+
+// Pre-rendered text for every value 0-255
+struct DecimalTable {
+  DecimalText values[MAX_COLOR_VALUE + 1];
+
+  DecimalTable() {
+    for (int value = 0; value <= MAX_COLOR_VALUE; ++value) {
+      DecimalText &text = values[value];
+      std::string digits = std::to_string(value) + " ";
+      std::memset(text.digits, ' ', sizeof(text.digits));
+      std::memcpy(text.digits, digits.data(), digits.size());
+      text.length = digits.size();
+    }
+  }
+};
+
+inline const DecimalTable &decimalTable() {
+  static const DecimalTable table;
+  return table;
+}
+
+// Formats one row of color values as P3 text ("r g b r g b ... \n").
+// out needs room for (valueCount * 4) + 1 bytes. Returns the end of
+// the written text.
+inline char *formatPlainRow(const unsigned char *values, std::size_t valueCount, char *out) {
+  const DecimalTable &decimals = decimalTable();
+  for (std::size_t i = 0; i < valueCount; ++i) {
+    const DecimalText &text = decimals.values[values[i]];
+    std::memcpy(out, text.digits, 4);
+    out += text.length;
+  }
+  *out++ = '\n';
+  return out;
+}
+
+} // namespace PPMFormat
+
+#endif
@@ -0,0 +1,112 @@
+/** @file PPMStream.h
+ *  @brief Row-by-row PPM reading and writing
+ *
+ *  PPMReader and PPMWriter move an image through memory a few rows
+ *  at a time, so images far larger than RAM (for example gigapixel
+ *  terrain height maps) can be converted and filtered with a small,
+ *  fixed amount of memory. Rows are always 8-bit packed R,G,B, the
+ *  same layout the PPM class uses.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef PPMSTREAM_H
+#define PPMSTREAM_H
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "PPM.h"
+
+// Reads a P3, P5 or P6 file one band of rows at a time
+class PPMReader {
+public:
+  // Opens fileName and reads its header. bufferSize is how much of
+  // the file is held in memory at once.
+  explicit PPMReader(const std::string &fileName, std::size_t bufferSize = 1 << 20);
+
+  PPMReader(const PPMReader &) = delete;
+  PPMReader &operator=(const PPMReader &) = delete;
+
+  // Returns true if the file was opened and has a valid header
+  inline bool isOpen() const { return m_open; }
+  inline int getWidth() const { return m_width; }
+  inline int getHeight() const { return m_height; }
+  // Number of rows not read yet
+  inline int rowsRemaining() const { return m_height - m_row; }
+
+  // Reads the next rowCount rows (clamped to the rows remaining) into
+  // rgb, which needs room for width * rowCount * 3 bytes. Returns the
+  // number of rows read, or 0 at the end of the image or on an error.
+  int readRows(unsigned char *rgb, int rowCount);
+
+private:
+  // Moves unread bytes to the front of the buffer and reads more of
+  // the file after them. Returns false if nothing more could be read.
+  bool refill();
+  // Skips whitespace and comments. Returns false at the end of the file.
+  bool skipSeparators();
+  // Reads the next decimal integer of the header or a P3 body
+  bool readInt(int &value);
+  // Copies the next count bytes of a binary body into out
+  bool readBytes(unsigned char *out, std::size_t count);
+
+  std::ifstream m_file;
+  std::vector<char> m_buffer;
+  // Unread part of m_buffer
+  const char *m_pos{ nullptr };
+  const char *m_end{ nullptr };
+  bool m_inComment{ false };
+  bool m_open{ false };
+
+  PPM::Format m_format{ PPM::P3 };
+  int m_width{ 0 };
+  int m_height{ 0 };
+  int m_maxValue{ 0 };
+  int m_row{ 0 };
+  std::vector<unsigned char> m_colorScale;
+  // Raw samples of binary rows before conversion
+  std::vector<unsigned char> m_samples;
+};
+
+// Writes a P3, P5 or P6 file one band of rows at a time
+class PPMWriter {
+public:
+  // Creates fileName and writes the header for a width x height image
+  PPMWriter(const std::string &fileName, int width, int height, PPM::Format format = PPM::P3);
+
+  PPMWriter(const PPMWriter &) = delete;
+  PPMWriter &operator=(const PPMWriter &) = delete;
+
+  // Returns true if the file was created
+  inline bool isOpen() const { return m_file.is_open(); }
+  // Number of rows not written yet
+  inline int rowsRemaining() const { return m_height - m_row; }
+
+  // Writes rowCount rows of packed R,G,B pixels. Returns false if more
+  // rows are given than the image has left, or the write fails.
+  bool writeRows(const unsigned char *rgb, int rowCount);
+
+private:
+  std::ofstream m_file;
+  PPM::Format m_format;
+  int m_width;
+  int m_height;
+  int m_row{ 0 };
+  // Text or grayscale rows before they are written
+  std::vector<char> m_scratch;
+};
+
+// A filter applied to a band of packed R,G,B pixels in place
+typedef std::function<void(unsigned char *rgb, std::size_t pixelCount)> RowFilter;
+
+// Copies inputFileName to outputFileName in the given format, bandRows
+// rows at a time, passing each band through filter first (if set).
+// Memory use is bounded by the band size, not the image size.
+// Returns false if either file could not be used.
+bool streamPPM(const std::string &inputFileName, const std::string &outputFileName,
+  PPM::Format format, int bandRows, const RowFilter &filter);
+
+#endif
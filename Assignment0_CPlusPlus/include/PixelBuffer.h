@@ -0,0 +1,100 @@
+/** @file PixelBuffer.h
+ *  @brief Owning, aligned byte buffer for pixel data
+ *
+ *  Memory is aligned to PixelBuffer::ALIGNMENT bytes so SIMD kernels
+ *  can use aligned loads, and is released automatically. Copies are
+ *  deep and moves steal the allocation. Shrinking or regrowing within
+ *  the current capacity never touches the allocator, so one buffer
+ *  can be reused for a whole series of images.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef PIXELBUFFER_H
+#define PIXELBUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+class PixelBuffer {
+public:
+  // Alignment of the allocation in bytes (one cache line, enough for AVX)
+  static constexpr std::size_t ALIGNMENT = 64;
+
+  PixelBuffer() = default;
+
+  // Allocates size bytes (contents uninitialized)
+  explicit PixelBuffer(std::size_t size) { resize(size); }
+
+  PixelBuffer(const PixelBuffer &other) {
+    resize(other.m_size);
+    if (m_size > 0) std::memcpy(m_data, other.m_data, m_size);
+  }
+
+  PixelBuffer(PixelBuffer &&other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_capacity(other.m_capacity) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+  }
+
+  PixelBuffer &operator=(const PixelBuffer &other) {
+    if (this != &other) {
+      resize(other.m_size);
+      if (m_size > 0) std::memcpy(m_data, other.m_data, m_size);
+    }
+    return *this;
+  }
+
+  PixelBuffer &operator=(PixelBuffer &&other) noexcept {
+    if (this != &other) {
+      release();
+      m_data = other.m_data;
+      m_size = other.m_size;
+      m_capacity = other.m_capacity;
+      other.m_data = nullptr;
+      other.m_size = 0;
+      other.m_capacity = 0;
+    }
+    return *this;
+  }
+
+  ~PixelBuffer() { release(); }
+
+  // Sets the size in bytes. Existing memory is reused when it is large
+  // enough; otherwise it is replaced and the old contents are lost.
+  void resize(std::size_t size) {
+    if (size > m_capacity) {
+      release();
+      m_data = static_cast<unsigned char *>(::operator new(size, std::align_val_t(ALIGNMENT)));
+      m_capacity = size;
+    }
+    m_size = size;
+  }
+
+  // Empties the buffer but keeps its memory for later reuse
+  void clear() { m_size = 0; }
+
+  inline unsigned char *data() { return m_data; }
+  inline const unsigned char *data() const { return m_data; }
+  inline std::size_t size() const { return m_size; }
+  inline std::size_t capacity() const { return m_capacity; }
+  inline bool empty() const { return m_size == 0; }
+
+private:
+  void release() {
+    if (m_data != nullptr) {
+      ::operator delete(m_data, std::align_val_t(ALIGNMENT));
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+  }
+
+  unsigned char *m_data{ nullptr };
+  std::size_t m_size{ 0 };
+  std::size_t m_capacity{ 0 };
+};
+
+#endif
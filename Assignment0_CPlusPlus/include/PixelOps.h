@@ -0,0 +1,55 @@
+/** @file PixelOps.h
+ *  @brief Whole-buffer pixel operations
+ *
+ *  Kernels that run over raw 8-bit pixel data as one flat span
+ *  instead of pixel by pixel. The byte-wise kernels work on any
+ *  number of channels; the color kernels expect packed R,G,B.
+ *
+ *  SSE2 is used on x86-64, and AVX2 (plus SSSE3 for grayscale) when
+ *  the library is compiled with those instruction sets enabled.
+ *  The versions in PixelOps::scalar are the portable reference
+ *  implementations and produce bit-identical results.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef PIXELOPS_H
+#define PIXELOPS_H
+
+#include <cstddef>
+
+namespace PixelOps {
+
+// Subtracts amount from every byte, clamping at 0
+void subtractSaturate(unsigned char *data, std::size_t count, unsigned char amount);
+// Adds amount to every byte, clamping at 255
+void addSaturate(unsigned char *data, std::size_t count, unsigned char amount);
+// Replaces every byte with 255 minus its value
+void invert(unsigned char *data, std::size_t count);
+// Sets every byte at or above level to 255 and the rest to 0
+void threshold(unsigned char *data, std::size_t count, unsigned char level);
+// Replaces each R,G,B pixel with its Rec. 601 luma in all three channels
+void grayscale(unsigned char *rgb, std::size_t pixelCount);
+// Maps each channel of each R,G,B pixel through its own 256-entry table
+void applyLUT(unsigned char *rgb, std::size_t pixelCount,
+  const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB);
+
+// Rec. 601 luma in 8-bit fixed point
+inline unsigned char luma(unsigned char r, unsigned char g, unsigned char b) {
+  return static_cast<unsigned char>(((77 * r) + (150 * g) + (29 * b) + 128) >> 8);
+}
+
+// Reference implementations of the kernels above
+namespace scalar {
+void subtractSaturate(unsigned char *data, std::size_t count, unsigned char amount);
+void addSaturate(unsigned char *data, std::size_t count, unsigned char amount);
+void invert(unsigned char *data, std::size_t count);
+void threshold(unsigned char *data, std::size_t count, unsigned char level);
+void grayscale(unsigned char *rgb, std::size_t pixelCount);
+void applyLUT(unsigned char *rgb, std::size_t pixelCount,
+  const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB);
+} // namespace scalar
+
+} // namespace PixelOps
+
+#endif
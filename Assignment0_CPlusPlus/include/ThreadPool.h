@@ -0,0 +1,61 @@
+/** @file ThreadPool.h
+ *  @brief Fixed-size pool of worker threads
+ *
+ *  Tasks are queued with submit() and picked up by the first free
+ *  worker. A task may split its own work with parallelFor(); the
+ *  calling thread works through the chunks alongside any idle
+ *  workers, so nested work cannot starve the pool.
+ *
+ *  @author your_name_here
+ *  @bug No known bugs.
+ */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+  // Starts threadCount workers (at least one)
+  explicit ThreadPool(unsigned int threadCount);
+  // Finishes all queued tasks, then joins the workers
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Queues a task to run on a worker
+  void submit(std::function<void()> task);
+  // Blocks until every submitted task has finished
+  void wait();
+  // Calls body(begin, end) over [0, count) in chunks of chunkSize,
+  // spreading the chunks over the pool, and returns once all are done
+  void parallelFor(std::size_t count, std::size_t chunkSize,
+    const std::function<void(std::size_t, std::size_t)> &body);
+
+  // Number of worker threads
+  inline unsigned int threadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+  // Loop each worker runs until the pool shuts down
+  void workerLoop();
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  // Signalled when a task is queued or the pool shuts down
+  std::condition_variable m_taskAvailable;
+  // Signalled when a task finishes
+  std::condition_variable m_taskFinished;
+  // Tasks queued or running
+  std::size_t m_unfinished{ 0 };
+  bool m_stopping{ false };
+};
+
+#endif
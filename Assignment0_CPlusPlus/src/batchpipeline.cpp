@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include "BatchPipeline.h"
+#include "PPMStream.h"
+#include "PixelOps.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Rough size of one band of rows; small enough to stay in cache
+// while the whole operation chain runs over it
+const std::size_t BAND_BYTES = 256 * 1024;
+
+typedef std::chrono::steady_clock Clock;
+
+// Bytes handled and time spent by one stage, summed over all threads
+struct StageStats {
+  std::atomic<std::uint64_t> bytes{ 0 };
+  std::atomic<std::uint64_t> nanoseconds{ 0 };
+
+  void add(std::uint64_t byteCount, Clock::time_point start) {
+    bytes += byteCount;
+    nanoseconds += static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+  }
+};
+
+void printStage(const char *name, const StageStats &stats, double wallSeconds) {
+  double megabytes = stats.bytes / (1024.0 * 1024.0);
+  double busySeconds = stats.nanoseconds / 1e9;
+  std::printf("%-8s %10.1f MB %9.3f s busy %10.1f MB/s per thread %10.1f MB/s overall\n",
+    name, megabytes, busySeconds,
+    busySeconds > 0 ? megabytes / busySeconds : 0.0,
+    wallSeconds > 0 ? megabytes / wallSeconds : 0.0);
+}
+
+// Reads text as a whole decimal number from minimum to maximum.
+// Returns false if it is empty, has anything after the number, or
+// is out of range.
+bool parseNumber(const char *text, long minimum, long maximum, long &value) {
+  char *end;
+  errno = 0;
+  value = std::strtol(text, &end, 10);
+  return end != text && *end == '\0' && errno != ERANGE && value >= minimum && value <= maximum;
+}
+
+std::uint64_t fileSize(const fs::path &path) {
+  std::error_code error;
+  std::uintmax_t size = fs::file_size(path, error);
+  return error ? 0 : static_cast<std::uint64_t>(size);
+}
+
+} // namespace
+
+// Turns an operation name into a BatchOperation. Accepted names are
+// darken, brighten, invert, grayscale and threshold[=level].
+bool parseBatchOperation(const std::string &text, BatchOperation &operation) {
+  operation.name = text;
+  if (text == "darken") {
+    operation.apply = PPM::darkenPixels;
+  }
+  else if (text == "brighten") {
+    operation.apply = [](unsigned char *rgb, std::size_t pixelCount) {
+      PixelOps::addSaturate(rgb, pixelCount * 3, 50);
+    };
+  }
+  else if (text == "invert") {
+    operation.apply = [](unsigned char *rgb, std::size_t pixelCount) {
+      PixelOps::invert(rgb, pixelCount * 3);
+    };
+  }
+  else if (text == "grayscale") {
+    operation.apply = [](unsigned char *rgb, std::size_t pixelCount) {
+      PixelOps::grayscale(rgb, pixelCount);
+    };
+  }
+  else if (text == "threshold" || text.compare(0, 10, "threshold=") == 0) {
+    long level = 128;
+    if (text.size() > 9 && !parseNumber(text.c_str() + 10, 0, 255, level)) return false;
+    operation.apply = [level](unsigned char *rgb, std::size_t pixelCount) {
+      PixelOps::threshold(rgb, pixelCount * 3, static_cast<unsigned char>(level));
+    };
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+// Processes every .ppm file in the input directory and prints the
+// throughput of each stage. Returns the number of images that failed.
+int runBatch(const BatchOptions &options) {
+  std::error_code error;
+  std::vector<fs::path> inputs;
+  for (const fs::directory_entry &entry : fs::directory_iterator(options.inputDirectory, error)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".ppm") {
+      inputs.push_back(entry.path());
+    }
+  }
+  if (error) {
+    std::cout << "Unable to read directory " << options.inputDirectory << std::endl;
+    return 1;
+  }
+  std::sort(inputs.begin(), inputs.end());
+  fs::create_directories(options.outputDirectory, error);
+
+  unsigned int threadCount = options.threadCount;
+  if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+  ThreadPool pool(threadCount);
+
+  StageStats loadStats, processStats, saveStats;
+  std::atomic<int> failures(0);
+  Clock::time_point batchStart = Clock::now();
+
+  for (const fs::path &input : inputs) {
+    pool.submit([&, input]() {
+      // Parse. Each worker keeps one image and reloads into it,
+      // so its pixel memory is reused from one file to the next.
+      thread_local PPM image;
+      Clock::time_point start = Clock::now();
+      if (!image.reload(input.string())) {
+        ++failures;
+        return;
+      }
+      loadStats.add(fileSize(input), start);
+
+      // Process, one band of rows at a time with every operation
+      // applied to a band before moving on to the next
+      start = Clock::now();
+      const std::size_t width = static_cast<std::size_t>(image.getWidth());
+      const std::size_t rowBytes = width * 3;
+      const std::size_t rowsPerBand = std::max<std::size_t>(1, BAND_BYTES / rowBytes);
+      unsigned char *pixels = image.pixelData();
+      pool.parallelFor(image.getHeight(), rowsPerBand, [&](std::size_t begin, std::size_t end) {
+        for (const BatchOperation &operation : options.operations) {
+          operation.apply(pixels + (begin * rowBytes), (end - begin) * width);
+        }
+      });
+      processStats.add(rowBytes * image.getHeight() * options.operations.size(), start);
+
+      // Encode
+      start = Clock::now();
+      fs::path output = fs::path(options.outputDirectory) / input.filename();
+      if (!image.savePPM(output.string(), options.outputFormat)) {
+        ++failures;
+        return;
+      }
+      saveStats.add(fileSize(output), start);
+    });
+  }
+  pool.wait();
+
+  double wallSeconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+  std::printf("%zu images, %d failed, %u threads, %.3f s\n",
+    inputs.size(), failures.load(), pool.threadCount(), wallSeconds);
+  printStage("load", loadStats, wallSeconds);
+  printStage("process", processStats, wallSeconds);
+  printStage("save", saveStats, wallSeconds);
+  return failures;
+}
+
+namespace {
+
+const char *USAGE =
+  "Usage: --batch <inputDir> <outputDir> [--threads N] [--format P3|P5|P6] <operation>...\n"
+  "       --stream <input.ppm> <output.ppm> [--band-rows N] [--format P3|P5|P6] <operation>...\n"
+  "Operations: darken brighten invert grayscale threshold[=level]";
+
+// Parses the options and operations that follow the two paths of a
+// --batch or --stream command. Returns false on an unknown argument
+// or a count that is not a whole number.
+bool parseCommandOptions(int argc, char **argv, BatchOptions &options, int &bandRows) {
+  options.inputDirectory = argv[2];
+  options.outputDirectory = argv[3];
+  for (int i = 4; i < argc; ++i) {
+    std::string argument = argv[i];
+    if ((argument == "--threads" || argument == "--band-rows") && i + 1 < argc) {
+      // At least one band row; zero threads means one per core
+      long value;
+      if (!parseNumber(argv[++i], argument == "--threads" ? 0 : 1, INT_MAX, value)) {
+        std::cout << "Invalid " << argument << " " << argv[i] << "\n" << USAGE << std::endl;
+        return false;
+      }
+      if (argument == "--threads") options.threadCount = static_cast<unsigned int>(value);
+      else bandRows = static_cast<int>(value);
+    }
+    else if (argument == "--format" && i + 1 < argc) {
+      std::string format = argv[++i];
+      if (format == "P3") options.outputFormat = PPM::P3;
+      else if (format == "P5") options.outputFormat = PPM::P5;
+      else if (format == "P6") options.outputFormat = PPM::P6;
+      else {
+        std::cout << "Unknown format " << format << std::endl;
+        return false;
+      }
+    }
+    else {
+      BatchOperation operation;
+      if (!parseBatchOperation(argument, operation)) {
+        std::cout << "Unknown operation " << argument << "\n" << USAGE << std::endl;
+        return false;
+      }
+      options.operations.push_back(operation);
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// Entry point for the --batch command line mode
+int runBatchCommand(int argc, char **argv) {
+  BatchOptions options;
+  int bandRows = 0;
+  if (argc < 4) {
+    std::cout << USAGE << std::endl;
+    return 1;
+  }
+  if (!parseCommandOptions(argc, argv, options, bandRows)) return 1;
+
+  return runBatch(options) == 0 ? 0 : 1;
+}
+
+// Entry point for the --stream command line mode
+int runStreamCommand(int argc, char **argv) {
+  BatchOptions options;
+  int bandRows = 64;
+  if (argc < 4) {
+    std::cout << USAGE << std::endl;
+    return 1;
+  }
+  if (!parseCommandOptions(argc, argv, options, bandRows)) return 1;
+
+  const std::vector<BatchOperation> &operations = options.operations;
+  bool done = streamPPM(options.inputDirectory, options.outputDirectory, options.outputFormat,
+    bandRows, [&operations](unsigned char *rgb, std::size_t pixelCount) {
+      for (const BatchOperation &operation : operations) {
+        operation.apply(rgb, pixelCount);
+      }
+    });
+  return done ? 0 : 1;
+}
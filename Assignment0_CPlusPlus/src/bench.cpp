@@ -0,0 +1,219 @@
+// Benchmarks for the PPM library.
+//
+// Run from the build directory. Test images are generated next to
+// the executable, so the first run takes a little while.
+//
+// Pass the path of an existing P3 texture to also compare load
+// times of the same image saved as P3, P6 and P5:
+//   ./PPMBench ../../objects/windmill/windmill_normal.ppm
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "PPM.h"
+
+namespace {
+
+// The original getline/stringstream/stoi parser, kept here as the
+// baseline the new loader is measured against.
+std::vector<unsigned char> legacyLoad(const std::string &fileName, int &width, int &height) {
+  std::vector<unsigned char> pixels;
+  std::ifstream inFile(fileName);
+  unsigned int i = 0, x = 0, y = 0;
+  int r = 0, g = 0, colorScale = 1;
+  std::string line;
+  while (getline(inFile, line)) {
+    std::size_t commentIndex = line.find("#");
+    if (commentIndex != std::string::npos) {
+      line = line.substr(0, commentIndex);
+    }
+    std::stringstream strstream(line);
+    std::string token;
+    while (getline(strstream, token, ' ')) {
+      if (token == "") continue;
+      if (i == 0) {
+        if (token != "P3") return pixels;
+      }
+      else if (i == 1) {
+        width = std::stoi(token);
+      }
+      else if (i == 2) {
+        height = std::stoi(token);
+        pixels.resize(width * height * 3);
+      }
+      else if (i == 3) {
+        colorScale = 255 / std::stoi(token);
+      }
+      else {
+        int colorIndex = (i - 4) % 3;
+        int colorValue = std::stoi(token) * colorScale;
+        if (colorIndex == 0) {
+          r = colorValue;
+        }
+        else if (colorIndex == 1) {
+          g = colorValue;
+        }
+        else {
+          int rIndex = ((y * width) + x) * 3;
+          pixels[rIndex] = r;
+          pixels[rIndex + 1] = g;
+          pixels[rIndex + 2] = colorValue;
+          if (++x == (unsigned int)width) {
+            x = 0;
+            ++y;
+          }
+        }
+      }
+      ++i;
+    }
+  }
+  return pixels;
+}
+
+// Writes a P3 image filled with pseudo-random colors, one image row per line.
+void writeTestImage(const std::string &fileName, int width, int height) {
+  std::ofstream outFile(fileName);
+  outFile << "P3\n# benchmark image\n" << width << " " << height << "\n255\n";
+  unsigned int state = 12345;
+  std::string row;
+  for (int y = 0; y < height; ++y) {
+    row.clear();
+    for (int x = 0; x < width * 3; ++x) {
+      state = state * 1664525u + 1013904223u;
+      row += std::to_string(state >> 24);
+      row += ' ';
+    }
+    row += '\n';
+    outFile << row;
+  }
+}
+
+template <typename Function>
+double timeMs(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void benchmarkLoad(const char *label, int width, int height) {
+  std::string fileName = std::string("bench_") + label + ".ppm";
+  writeTestImage(fileName, width, height);
+
+  int legacyWidth = 0, legacyHeight = 0;
+  std::vector<unsigned char> legacyPixels;
+  double legacyMs = timeMs([&]() {
+    legacyPixels = legacyLoad(fileName, legacyWidth, legacyHeight);
+  });
+
+  bool matches = false;
+  double mappedMs = timeMs([&]() {
+    PPM image(fileName);
+    matches = image.getWidth() == legacyWidth && image.getHeight() == legacyHeight &&
+      std::equal(legacyPixels.begin(), legacyPixels.end(), image.pixelData());
+  });
+
+  std::printf("%-3s %5dx%-5d legacy %9.1f ms   mmap %8.1f ms   speedup %5.1fx   %s\n",
+    label, width, height, legacyMs, mappedMs, legacyMs / mappedMs,
+    matches ? "identical" : "MISMATCH");
+  std::remove(fileName.c_str());
+}
+
+// The original operator<< based P3 writer, kept as the baseline
+// for the buffered encoder.
+void legacySave(const std::string &fileName, const unsigned char *pixels, int width, int height) {
+  std::ofstream outFile;
+  outFile.open(fileName);
+  outFile << "P3" << std::endl;
+  outFile << width << " " << height << std::endl;
+  outFile << 255 << std::endl;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int rIndex = ((y * width) + x) * 3;
+      int r = pixels[rIndex];
+      int g = pixels[rIndex + 1];
+      int b = pixels[rIndex + 2];
+      outFile << r << " " << g << " " << b << " ";
+    }
+    outFile << std::endl;
+  }
+  outFile.close();
+}
+
+std::string readFile(const std::string &fileName) {
+  std::ifstream file(fileName, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+void benchmarkSave(const char *label, int width, int height) {
+  std::string inputName = std::string("bench_") + label + ".ppm";
+  std::string legacyName = std::string("bench_") + label + "_legacy.ppm";
+  std::string encodedName = std::string("bench_") + label + "_encoded.ppm";
+  writeTestImage(inputName, width, height);
+  PPM image(inputName);
+
+  double legacyMs = timeMs([&]() {
+    legacySave(legacyName, image.pixelData(), image.getWidth(), image.getHeight());
+  });
+  double encodedMs = timeMs([&]() {
+    image.savePPM(encodedName);
+  });
+  bool matches = readFile(legacyName) == readFile(encodedName);
+
+  std::printf("%-3s %5dx%-5d legacy %9.1f ms   buffered %8.1f ms   speedup %5.1fx   %s\n",
+    label, width, height, legacyMs, encodedMs, legacyMs / encodedMs,
+    matches ? "identical" : "MISMATCH");
+  std::remove(inputName.c_str());
+  std::remove(legacyName.c_str());
+  std::remove(encodedName.c_str());
+}
+
+long fileSize(const std::string &fileName) {
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  return static_cast<long>(file.tellg());
+}
+
+void benchmarkFormats(const std::string &textureName) {
+  const int runs = 20;
+  const char *labels[] = { "P3", "P5", "P6" };
+  const PPM::Format formats[] = { PPM::P3, PPM::P5, PPM::P6 };
+
+  PPM texture(textureName);
+  for (int f = 0; f < 3; ++f) {
+    std::string fileName = std::string("bench_texture_") + labels[f] + ".ppm";
+    texture.savePPM(fileName, formats[f]);
+
+    double totalMs = timeMs([&]() {
+      for (int run = 0; run < runs; ++run) {
+        PPM image(fileName);
+      }
+    });
+    std::printf("%s  %9ld bytes   load %7.2f ms\n",
+      labels[f], fileSize(fileName), totalMs / runs);
+    std::remove(fileName.c_str());
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::cout << "P3 load time" << std::endl;
+  benchmarkLoad("4K", 3840, 2160);
+  benchmarkLoad("8K", 7680, 4320);
+
+  std::cout << "P3 save time" << std::endl;
+  benchmarkSave("4K", 3840, 2160);
+  benchmarkSave("8K", 7680, 4320);
+
+  if (argc > 1) {
+    std::cout << "Load time by format for " << argv[1] << std::endl;
+    benchmarkFormats(argv[1]);
+  }
+  return 0;
+}
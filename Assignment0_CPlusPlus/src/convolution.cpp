@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include "Convolution.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVOLUTION_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define CONVOLUTION_AVX
+#include <immintrin.h>
+#endif
+
+namespace Convolution {
+
+namespace {
+
+// Rows per band when the work is not spread over a pool
+const int SERIAL_BAND_ROWS = 64;
+
+// acc[i] += weight * in[i] over a whole row of values
+void multiplyAdd(float *acc, const float *in, float weight, std::size_t count) {
+  std::size_t i = 0;
+#ifdef CONVOLUTION_AVX
+  const __m256 weights8 = _mm256_set1_ps(weight);
+  for (; i + 8 <= count; i += 8) {
+    __m256 product = _mm256_mul_ps(_mm256_loadu_ps(in + i), weights8);
+    _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), product));
+  }
+#endif
+#ifdef CONVOLUTION_SSE2
+  const __m128 weights4 = _mm_set1_ps(weight);
+  for (; i + 4 <= count; i += 4) {
+    __m128 product = _mm_mul_ps(_mm_loadu_ps(in + i), weights4);
+    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), product));
+  }
+#endif
+  for (; i < count; ++i) {
+    acc[i] += weight * in[i];
+  }
+}
+
+// sum[i] += add[i] - remove[i] over a whole row of running sums
+void slideSums(std::int32_t *sum, const std::int32_t *add, const std::int32_t *remove,
+  std::size_t count) {
+  std::size_t i = 0;
+#ifdef CONVOLUTION_SSE2
+  for (; i + 4 <= count; i += 4) {
+    __m128i total = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sum + i));
+    total = _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + i)));
+    total = _mm_sub_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i *>(remove + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(sum + i), total);
+  }
+#endif
+  for (; i < count; ++i) {
+    sum[i] += add[i] - remove[i];
+  }
+}
+
+// Rounds one value to the nearest 8-bit color (halves round up)
+inline unsigned char toColor(float value) {
+  value += 0.5f;
+  return (value <= 0.0f) ? 0 : (value >= 255.0f) ? 255 : static_cast<unsigned char>(value);
+}
+
+// Rounds a row of values to 8-bit colors
+void storeRow(const float *values, unsigned char *out, std::size_t count) {
+  std::size_t i = 0;
+#ifdef CONVOLUTION_SSE2
+  // Truncating value + 0.5 matches toColor once values are clamped
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 maximum = _mm_set1_ps(255.0f);
+  for (; i + 16 <= count; i += 16) {
+    __m128i quarters[4];
+    for (int q = 0; q < 4; ++q) {
+      __m128 v = _mm_min_ps(_mm_add_ps(_mm_loadu_ps(values + i + (4 * q)), half), maximum);
+      quarters[q] = _mm_cvttps_epi32(v);
+    }
+    __m128i low = _mm_packs_epi32(quarters[0], quarters[1]);
+    __m128i high = _mm_packs_epi32(quarters[2], quarters[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = toColor(values[i]);
+  }
+}
+
+// Copies source row y (clamped to the image) into padded, with each
+// edge pixel repeated radius more times on its side
+template <typename T>
+void padRow(const unsigned char *src, int width, int height, int y, int radius, T *padded) {
+  const unsigned char *row = src + (static_cast<std::size_t>(std::clamp(y, 0, height - 1)) * width * 3);
+  for (int x = -radius; x < width + radius; ++x) {
+    const unsigned char *pixel = row + (std::clamp(x, 0, width - 1) * 3);
+    T *out = padded + ((x + radius) * 3);
+    out[0] = pixel[0];
+    out[1] = pixel[1];
+    out[2] = pixel[2];
+  }
+}
+
+// Calls band(firstRow, endRow) over every row of the image, bandRows
+// rows at a time, on pool when there is one
+void forEachBand(int height, int bandRows, ThreadPool *pool,
+  const std::function<void(int, int)> &band) {
+  if (pool != nullptr) {
+    pool->parallelFor(height, bandRows, [&band](std::size_t begin, std::size_t end) {
+      band(static_cast<int>(begin), static_cast<int>(end));
+    });
+    return;
+  }
+  for (int y = 0; y < height; y += bandRows) {
+    band(y, std::min(y + bandRows, height));
+  }
+}
+
+// Bands small enough that every thread of the pool gets several
+int bandRowsFor(int height, ThreadPool *pool) {
+  if (pool == nullptr) return SERIAL_BAND_ROWS;
+  int bands = static_cast<int>(pool->threadCount()) * 4;
+  return std::max(16, (height + bands - 1) / bands);
+}
+
+// Direct 2D sum over every weight for rows [y0, y1)
+void naiveBand(const unsigned char *src, unsigned char *dst, int width, int height,
+  const Kernel &kernel, int y0, int y1) {
+  const int radius = kernel.radius;
+  for (int y = y0; y < y1; ++y) {
+    for (int x = 0; x < width; ++x) {
+      float sum[3] = { 0.0f, 0.0f, 0.0f };
+      for (int ky = 0; ky < kernel.size(); ++ky) {
+        int sy = std::clamp(y + ky - radius, 0, height - 1);
+        for (int kx = 0; kx < kernel.size(); ++kx) {
+          int sx = std::clamp(x + kx - radius, 0, width - 1);
+          const unsigned char *pixel = src + ((static_cast<std::size_t>(sy) * width + sx) * 3);
+          float weight = kernel.at(kx, ky);
+          sum[0] += weight * pixel[0];
+          sum[1] += weight * pixel[1];
+          sum[2] += weight * pixel[2];
+        }
+      }
+      unsigned char *out = dst + ((static_cast<std::size_t>(y) * width + x) * 3);
+      out[0] = toColor(sum[0]);
+      out[1] = toColor(sum[1]);
+      out[2] = toColor(sum[2]);
+    }
+  }
+}
+
+// Runs the row pass then the column pass over rows [y0, y1), calling
+// emit(y, values) with the filtered values of each row. The row pass
+// results for the 2r + 1 rows under the kernel are kept in a ring, so
+// each source row is filtered horizontally once per band.
+void separableBand(const unsigned char *src, int width, int height,
+  const std::vector<float> &column, const std::vector<float> &row, int y0, int y1,
+  const std::function<void(int, const float *)> &emit) {
+  const int radius = static_cast<int>(row.size() / 2);
+  const int taps = static_cast<int>(row.size());
+  const std::size_t rowValues = static_cast<std::size_t>(width) * 3;
+
+  thread_local std::vector<float> padded, ring, acc;
+  padded.resize((width + (2 * radius)) * 3);
+  ring.resize(rowValues * taps);
+  acc.resize(rowValues);
+
+  // Filters source row sy horizontally into its ring slot
+  auto filterRow = [&](int sy) {
+    float *out = ring.data() + (((sy - y0 + radius) % taps) * rowValues);
+    padRow(src, width, height, sy, radius, padded.data());
+    std::fill(out, out + rowValues, 0.0f);
+    for (int k = 0; k < taps; ++k) {
+      if (row[k] != 0.0f) multiplyAdd(out, padded.data() + (k * 3), row[k], rowValues);
+    }
+  };
+
+  for (int sy = y0 - radius; sy < y0 + radius; ++sy) {
+    filterRow(sy);
+  }
+  for (int y = y0; y < y1; ++y) {
+    filterRow(y + radius);
+    std::fill(acc.begin(), acc.end(), 0.0f);
+    for (int k = 0; k < taps; ++k) {
+      if (column[k] == 0.0f) continue;
+      const float *in = ring.data() + (((y - y0 + k) % taps) * rowValues);
+      multiplyAdd(acc.data(), in, column[k], rowValues);
+    }
+    emit(y, acc.data());
+  }
+}
+
+// Box filter over rows [y0, y1) with running sums: along each row,
+// then down the columns, so the cost does not grow with the radius
+void boxBand(const unsigned char *src, unsigned char *dst, int width, int height,
+  int radius, float weight, int y0, int y1) {
+  const int taps = (2 * radius) + 1;
+  const std::size_t rowValues = static_cast<std::size_t>(width) * 3;
+
+  thread_local std::vector<unsigned char> padded;
+  thread_local std::vector<std::int32_t> ring, columnSums;
+  thread_local std::vector<float> values;
+  // One slot more than the window, so the row entering it never
+  // overwrites the row leaving it
+  const int slots = taps + 1;
+  padded.resize((width + (2 * radius)) * 3);
+  ring.resize(rowValues * slots);
+  columnSums.assign(rowValues, 0);
+  values.resize(rowValues);
+
+  // Sums source row sy horizontally into its ring slot
+  auto sumRow = [&](int sy) -> std::int32_t * {
+    std::int32_t *out = ring.data() + (((sy - y0 + radius) % slots) * rowValues);
+    padRow(src, width, height, sy, radius, padded.data());
+    const unsigned char *p = padded.data();
+    for (int c = 0; c < 3; ++c) {
+      std::int32_t sum = 0;
+      for (int k = 0; k < taps; ++k) sum += p[(k * 3) + c];
+      out[c] = sum;
+    }
+    for (std::size_t i = 3; i < rowValues; ++i) {
+      out[i] = out[i - 3] + p[i + (taps - 1) * 3] - p[i - 3];
+    }
+    return out;
+  };
+
+  for (int sy = y0 - radius; sy <= y0 + radius; ++sy) {
+    const std::int32_t *sums = sumRow(sy);
+    for (std::size_t i = 0; i < rowValues; ++i) columnSums[i] += sums[i];
+  }
+  for (int y = y0; y < y1; ++y) {
+    for (std::size_t i = 0; i < rowValues; ++i) {
+      values[i] = static_cast<float>(columnSums[i]) * weight;
+    }
+    storeRow(values.data(), dst + (y * rowValues), rowValues);
+
+    if (y + 1 < y1) {
+      const std::int32_t *leaving = ring.data() + (((y - y0) % slots) * rowValues);
+      const std::int32_t *entering = sumRow(y + radius + 1);
+      slideSums(columnSums.data(), entering, leaving, rowValues);
+    }
+  }
+}
+
+} // namespace
+
+Kernel makeKernel(int radius, const std::vector<float> &weights) {
+  Kernel kernel;
+  kernel.radius = std::max(radius, 0);
+  kernel.weights = weights;
+  // Missing weights are 0
+  kernel.weights.resize(kernel.size() * kernel.size(), 0.0f);
+  return kernel;
+}
+
+Kernel boxKernel(int radius) {
+  radius = std::max(radius, 0);
+  int size = (2 * radius) + 1;
+  return makeKernel(radius, std::vector<float>(size * size, 1.0f / (size * size)));
+}
+
+Kernel gaussianKernel(int radius, float sigma) {
+  radius = std::max(radius, 0);
+  if (sigma <= 0.0f) sigma = (radius > 0) ? radius / 2.0f : 1.0f;
+  int size = (2 * radius) + 1;
+
+  std::vector<float> profile(size);
+  float total = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    float distance = static_cast<float>(i - radius);
+    profile[i] = std::exp(-(distance * distance) / (2.0f * sigma * sigma));
+    total += profile[i];
+  }
+
+  std::vector<float> weights(size * size);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      weights[(y * size) + x] = (profile[y] / total) * (profile[x] / total);
+    }
+  }
+  return makeKernel(radius, weights);
+}
+
+Kernel sharpenKernel() {
+  return makeKernel(1, {
+    -1, -1, -1,
+    -1,  9, -1,
+    -1, -1, -1
+  });
+}
+
+Kernel blurKernel() {
+  return makeKernel(1, {
+    1.0f / 16, 2.0f / 16, 1.0f / 16,
+    2.0f / 16, 4.0f / 16, 2.0f / 16,
+    1.0f / 16, 2.0f / 16, 1.0f / 16
+  });
+}
+
+Kernel sobelXKernel() {
+  return makeKernel(1, {
+    -1, 0, 1,
+    -2, 0, 2,
+    -1, 0, 1
+  });
+}
+
+Kernel sobelYKernel() {
+  return makeKernel(1, {
+    -1, -2, -1,
+     0,  0,  0,
+     1,  2,  1
+  });
+}
+
+bool isBox(const Kernel &kernel) {
+  return std::all_of(kernel.weights.begin(), kernel.weights.end(),
+    [&kernel](float weight) { return weight == kernel.weights[0]; });
+}
+
+bool separate(const Kernel &kernel, std::vector<float> &column, std::vector<float> &row) {
+  const int size = kernel.size();
+  column.assign(size, 0.0f);
+  row.assign(size, 0.0f);
+
+  // Use the largest weight as the pivot
+  int pivotX = 0, pivotY = 0;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      if (std::fabs(kernel.at(x, y)) > std::fabs(kernel.at(pivotX, pivotY))) {
+        pivotX = x;
+        pivotY = y;
+      }
+    }
+  }
+  const float pivot = kernel.at(pivotX, pivotY);
+  if (pivot == 0.0f) return true;
+
+  // If the kernel is an outer product, its pivot column and pivot row
+  // (scaled) are the two factors
+  for (int i = 0; i < size; ++i) {
+    column[i] = kernel.at(pivotX, i);
+    row[i] = kernel.at(i, pivotY) / pivot;
+  }
+  const float tolerance = 1e-5f * std::fabs(pivot);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      if (std::fabs(kernel.at(x, y) - (column[y] * row[x])) > tolerance) return false;
+    }
+  }
+  return true;
+}
+
+void convolve(const unsigned char *src, unsigned char *dst, int width, int height,
+  const Kernel &kernel, ThreadPool *pool, Method method) {
+  if (width <= 0 || height <= 0 || kernel.weights.empty()) return;
+  const std::size_t rowValues = static_cast<std::size_t>(width) * 3;
+  const int bandRows = bandRowsFor(height, pool);
+
+  std::vector<float> column, row;
+  if ((method == Automatic || method == Box) && isBox(kernel)) {
+    const float weight = kernel.weights[0];
+    forEachBand(height, bandRows, pool, [&](int y0, int y1) {
+      boxBand(src, dst, width, height, kernel.radius, weight, y0, y1);
+    });
+  }
+  else if ((method == Automatic || method == Separable) && separate(kernel, column, row)) {
+    forEachBand(height, bandRows, pool, [&](int y0, int y1) {
+      separableBand(src, width, height, column, row, y0, y1, [&](int y, const float *values) {
+        storeRow(values, dst + (y * rowValues), rowValues);
+      });
+    });
+  }
+  else {
+    forEachBand(height, bandRows, pool, [&](int y0, int y1) {
+      naiveBand(src, dst, width, height, kernel, y0, y1);
+    });
+  }
+}
+
+void sobel(const unsigned char *src, unsigned char *dst, int width, int height,
+  ThreadPool *pool) {
+  if (width <= 0 || height <= 0) return;
+  const std::size_t rowValues = static_cast<std::size_t>(width) * 3;
+  const std::vector<float> smooth = { 1.0f, 2.0f, 1.0f };
+  const std::vector<float> slope = { -1.0f, 0.0f, 1.0f };
+
+  forEachBand(height, bandRowsFor(height, pool), pool, [&](int y0, int y1) {
+    // Horizontal gradients of the band, then vertical ones combined
+    // with them row by row
+    std::vector<float> gradientX((y1 - y0) * rowValues);
+    separableBand(src, width, height, smooth, slope, y0, y1, [&](int y, const float *values) {
+      std::copy(values, values + rowValues, gradientX.begin() + ((y - y0) * rowValues));
+    });
+    separableBand(src, width, height, slope, smooth, y0, y1, [&](int y, const float *values) {
+      const float *gx = gradientX.data() + ((y - y0) * rowValues);
+      unsigned char *out = dst + (y * rowValues);
+      for (std::size_t i = 0; i < rowValues; ++i) {
+        out[i] = toColor(std::sqrt((gx[i] * gx[i]) + (values[i] * values[i])));
+      }
+    });
+  });
+}
+
+} // namespace Convolution
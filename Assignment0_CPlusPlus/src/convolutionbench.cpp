@@ -0,0 +1,99 @@
+// Benchmarks for the convolution engine.
+//
+// Times the direct 2D sum against the separable and box paths for
+// Gaussian and box kernels at radii 1 to 32, plus the separable path
+// spread over a thread pool. The naive path at large radii is slow on
+// purpose, so the test image is kept small:
+//   ./ConvolutionBench [size]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Convolution.h"
+#include "ThreadPool.h"
+
+namespace {
+
+template <typename Function>
+double timeMs(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Pseudo-random packed R,G,B pixels
+std::vector<unsigned char> makeTestImage(int width, int height) {
+  std::vector<unsigned char> pixels(static_cast<std::size_t>(width) * height * 3);
+  unsigned int state = 12345;
+  for (unsigned char &value : pixels) {
+    state = state * 1664525u + 1013904223u;
+    value = static_cast<unsigned char>(state >> 24);
+  }
+  return pixels;
+}
+
+// Largest difference between two equally sized buffers
+int maxDifference(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b) {
+  int result = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    result = std::max(result, std::abs(a[i] - b[i]));
+  }
+  return result;
+}
+
+void benchmarkKernel(const char *label, Convolution::Kernel (*makeKernel)(int),
+  const std::vector<unsigned char> &src, int size, ThreadPool &pool) {
+  const int radii[] = { 1, 2, 4, 8, 16, 32 };
+  std::vector<unsigned char> naive(src.size()), fast(src.size());
+
+  std::printf("%s %dx%d\n", label, size, size);
+  std::printf("radius   naive 2D ms   separable ms   box ms   %u threads ms   speedup   max diff\n",
+    pool.threadCount());
+  for (int radius : radii) {
+    Convolution::Kernel kernel = makeKernel(radius);
+    double naiveMs = timeMs([&]() {
+      Convolution::convolve(src.data(), naive.data(), size, size, kernel, nullptr, Convolution::Naive);
+    });
+    double separableMs = timeMs([&]() {
+      Convolution::convolve(src.data(), fast.data(), size, size, kernel, nullptr, Convolution::Separable);
+    });
+    int difference = maxDifference(naive, fast);
+
+    double boxMs = 0.0;
+    if (Convolution::isBox(kernel)) {
+      boxMs = timeMs([&]() {
+        Convolution::convolve(src.data(), fast.data(), size, size, kernel, nullptr, Convolution::Box);
+      });
+      difference = std::max(difference, maxDifference(naive, fast));
+    }
+    double threadedMs = timeMs([&]() {
+      Convolution::convolve(src.data(), fast.data(), size, size, kernel, &pool);
+    });
+    difference = std::max(difference, maxDifference(naive, fast));
+
+    double bestMs = (boxMs > 0.0) ? std::min(separableMs, boxMs) : separableMs;
+    char boxText[16] = "     -";
+    if (boxMs > 0.0) std::snprintf(boxText, sizeof(boxText), "%6.2f", boxMs);
+    std::printf("%6d   %11.1f   %12.2f   %s   %12.2f   %6.1fx   %8d\n",
+      radius, naiveMs, separableMs, boxText, threadedMs, naiveMs / bestMs, difference);
+  }
+}
+
+Convolution::Kernel gaussian(int radius) {
+  return Convolution::gaussianKernel(radius);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int size = (argc > 1) ? std::max(std::atoi(argv[1]), 1) : 512;
+  std::vector<unsigned char> src = makeTestImage(size, size);
+  ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+  benchmarkKernel("Gaussian", gaussian, src, size, pool);
+  benchmarkKernel("Box", Convolution::boxKernel, src, size, pool);
+  return 0;
+}
@@ -1,7 +1,21 @@
 // Include our custom library
+#include <string>
 #include "PPM.h"
+#include "BatchPipeline.h"
 
-int main(){
+int main(int argc, char **argv){
+
+    // Batch mode: process a whole directory of images
+    //   Assignment0 --batch <inputDir> <outputDir> [options] <operation>...
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return runBatchCommand(argc, argv);
+    }
+
+    // Stream mode: filter one image of any size a band of rows at a time
+    //   Assignment0 --stream <input.ppm> <output.ppm> [options] <operation>...
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        return runStreamCommand(argc, argv);
+    }
 
     PPM myPPM("./textures/test1.ppm");
     myPPM.darken();
@@ -0,0 +1,279 @@
+#include "PixelOps.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXELOPS_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define PIXELOPS_SSSE3
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define PIXELOPS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace PixelOps {
+
+namespace scalar {
+
+void subtractSaturate(unsigned char *data, std::size_t count, unsigned char amount) {
+  for (std::size_t i = 0; i < count; ++i) {
+    data[i] = (data[i] > amount) ? (data[i] - amount) : 0;
+  }
+}
+
+void addSaturate(unsigned char *data, std::size_t count, unsigned char amount) {
+  const int limit = 255 - amount;
+  for (std::size_t i = 0; i < count; ++i) {
+    data[i] = (data[i] < limit) ? (data[i] + amount) : 255;
+  }
+}
+
+void invert(unsigned char *data, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    data[i] = 255 - data[i];
+  }
+}
+
+void threshold(unsigned char *data, std::size_t count, unsigned char level) {
+  for (std::size_t i = 0; i < count; ++i) {
+    data[i] = (data[i] >= level) ? 255 : 0;
+  }
+}
+
+void grayscale(unsigned char *rgb, std::size_t pixelCount) {
+  for (std::size_t i = 0; i < pixelCount; ++i) {
+    unsigned char *pixel = rgb + (i * 3);
+    unsigned char gray = luma(pixel[0], pixel[1], pixel[2]);
+    pixel[0] = gray;
+    pixel[1] = gray;
+    pixel[2] = gray;
+  }
+}
+
+void applyLUT(unsigned char *rgb, std::size_t pixelCount,
+  const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB) {
+  for (std::size_t i = 0; i < pixelCount; ++i) {
+    unsigned char *pixel = rgb + (i * 3);
+    pixel[0] = lutR[pixel[0]];
+    pixel[1] = lutG[pixel[1]];
+    pixel[2] = lutB[pixel[2]];
+  }
+}
+
+} // namespace scalar
+
+namespace {
+
+// Runs a byte-wise kernel 32 bytes at a time with AVX2, then 16 at a
+// time with SSE2, and leaves the remaining tail to the scalar version.
+// Returns the number of bytes processed.
+template <typename Avx2Op, typename Sse2Op>
+std::size_t forEachBlock(unsigned char *data, std::size_t count, Avx2Op avx2Op, Sse2Op sse2Op) {
+  std::size_t i = 0;
+#ifdef PIXELOPS_AVX2
+  for (; i + 32 <= count; i += 32) {
+    __m256i *block = reinterpret_cast<__m256i *>(data + i);
+    _mm256_storeu_si256(block, avx2Op(_mm256_loadu_si256(block)));
+  }
+#else
+  (void)avx2Op;
+#endif
+#ifdef PIXELOPS_SSE2
+  for (; i + 16 <= count; i += 16) {
+    __m128i *block = reinterpret_cast<__m128i *>(data + i);
+    _mm_storeu_si128(block, sse2Op(_mm_loadu_si128(block)));
+  }
+#else
+  (void)data;
+  (void)count;
+  (void)sse2Op;
+#endif
+  return i;
+}
+
+#ifdef PIXELOPS_AVX2
+typedef __m256i Avx2Vector;
+#else
+typedef int Avx2Vector;
+#endif
+#ifdef PIXELOPS_SSE2
+typedef __m128i Sse2Vector;
+#else
+typedef int Sse2Vector;
+#endif
+
+#ifdef PIXELOPS_SSSE3
+// Shuffle mask that gathers one channel of 16 packed R,G,B pixels
+// (48 bytes) out of the given 16-byte source block
+__m128i gatherMask(int channel, int block) {
+  alignas(16) char mask[16];
+  for (int i = 0; i < 16; ++i) {
+    int source = (3 * i) + channel - (16 * block);
+    mask[i] = (source >= 0 && source < 16) ? static_cast<char>(source) : static_cast<char>(0x80);
+  }
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+}
+
+// Shuffle mask that spreads 16 gray values back over the given
+// 16-byte block of packed R,G,B pixels
+__m128i scatterMask(int block) {
+  alignas(16) char mask[16];
+  for (int i = 0; i < 16; ++i) {
+    mask[i] = static_cast<char>(((16 * block) + i) / 3);
+  }
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+}
+#endif
+
+} // namespace
+
+void subtractSaturate(unsigned char *data, std::size_t count, unsigned char amount) {
+  std::size_t done = forEachBlock(data, count,
+    [amount](Avx2Vector v) {
+#ifdef PIXELOPS_AVX2
+      return _mm256_subs_epu8(v, _mm256_set1_epi8(static_cast<char>(amount)));
+#else
+      return v;
+#endif
+    },
+    [amount](Sse2Vector v) {
+#ifdef PIXELOPS_SSE2
+      return _mm_subs_epu8(v, _mm_set1_epi8(static_cast<char>(amount)));
+#else
+      return v;
+#endif
+    });
+  scalar::subtractSaturate(data + done, count - done, amount);
+}
+
+void addSaturate(unsigned char *data, std::size_t count, unsigned char amount) {
+  std::size_t done = forEachBlock(data, count,
+    [amount](Avx2Vector v) {
+#ifdef PIXELOPS_AVX2
+      return _mm256_adds_epu8(v, _mm256_set1_epi8(static_cast<char>(amount)));
+#else
+      return v;
+#endif
+    },
+    [amount](Sse2Vector v) {
+#ifdef PIXELOPS_SSE2
+      return _mm_adds_epu8(v, _mm_set1_epi8(static_cast<char>(amount)));
+#else
+      return v;
+#endif
+    });
+  scalar::addSaturate(data + done, count - done, amount);
+}
+
+void invert(unsigned char *data, std::size_t count) {
+  std::size_t done = forEachBlock(data, count,
+    [](Avx2Vector v) {
+#ifdef PIXELOPS_AVX2
+      return _mm256_xor_si256(v, _mm256_set1_epi8(-1));
+#else
+      return v;
+#endif
+    },
+    [](Sse2Vector v) {
+#ifdef PIXELOPS_SSE2
+      return _mm_xor_si128(v, _mm_set1_epi8(-1));
+#else
+      return v;
+#endif
+    });
+  scalar::invert(data + done, count - done);
+}
+
+void threshold(unsigned char *data, std::size_t count, unsigned char level) {
+  // v >= level exactly when max(v, level) == v
+  std::size_t done = forEachBlock(data, count,
+    [level](Avx2Vector v) {
+#ifdef PIXELOPS_AVX2
+      return _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(static_cast<char>(level))), v);
+#else
+      return v;
+#endif
+    },
+    [level](Sse2Vector v) {
+#ifdef PIXELOPS_SSE2
+      return _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(static_cast<char>(level))), v);
+#else
+      return v;
+#endif
+    });
+  scalar::threshold(data + done, count - done, level);
+}
+
+void grayscale(unsigned char *rgb, std::size_t pixelCount) {
+  std::size_t i = 0;
+#ifdef PIXELOPS_SSSE3
+  __m128i gather[3][3];
+  for (int channel = 0; channel < 3; ++channel) {
+    for (int block = 0; block < 3; ++block) {
+      gather[channel][block] = gatherMask(channel, block);
+    }
+  }
+  const __m128i scatter0 = scatterMask(0);
+  const __m128i scatter1 = scatterMask(1);
+  const __m128i scatter2 = scatterMask(2);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weightR = _mm_set1_epi16(77);
+  const __m128i weightG = _mm_set1_epi16(150);
+  const __m128i weightB = _mm_set1_epi16(29);
+  const __m128i round = _mm_set1_epi16(128);
+
+  // 16 pixels per iteration
+  for (; i + 16 <= pixelCount; i += 16) {
+    __m128i *blocks = reinterpret_cast<__m128i *>(rgb + (i * 3));
+    __m128i b0 = _mm_loadu_si128(blocks);
+    __m128i b1 = _mm_loadu_si128(blocks + 1);
+    __m128i b2 = _mm_loadu_si128(blocks + 2);
+
+    __m128i channels[3];
+    for (int channel = 0; channel < 3; ++channel) {
+      channels[channel] = _mm_or_si128(
+        _mm_or_si128(_mm_shuffle_epi8(b0, gather[channel][0]), _mm_shuffle_epi8(b1, gather[channel][1])),
+        _mm_shuffle_epi8(b2, gather[channel][2]));
+    }
+
+    // The weighted sum is at most 256 * 255 + 128, so it fits in 16 bits
+    __m128i lumaLo = _mm_add_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(channels[0], zero), weightR),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(channels[1], zero), weightG)),
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(channels[2], zero), weightB), round));
+    __m128i lumaHi = _mm_add_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(channels[0], zero), weightR),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(channels[1], zero), weightG)),
+      _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(channels[2], zero), weightB), round));
+    __m128i gray = _mm_packus_epi16(_mm_srli_epi16(lumaLo, 8), _mm_srli_epi16(lumaHi, 8));
+
+    _mm_storeu_si128(blocks, _mm_shuffle_epi8(gray, scatter0));
+    _mm_storeu_si128(blocks + 1, _mm_shuffle_epi8(gray, scatter1));
+    _mm_storeu_si128(blocks + 2, _mm_shuffle_epi8(gray, scatter2));
+  }
+#endif
+  scalar::grayscale(rgb + (i * 3), pixelCount - i);
+}
+
+void applyLUT(unsigned char *rgb, std::size_t pixelCount,
+  const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB) {
+  // Table lookups do not vectorize on SSE2/AVX2; four pixels per
+  // iteration keep the loads independent of each other
+  std::size_t i = 0;
+  for (; i + 4 <= pixelCount; i += 4) {
+    unsigned char *pixel = rgb + (i * 3);
+    unsigned char r0 = lutR[pixel[0]], g0 = lutG[pixel[1]], b0 = lutB[pixel[2]];
+    unsigned char r1 = lutR[pixel[3]], g1 = lutG[pixel[4]], b1 = lutB[pixel[5]];
+    unsigned char r2 = lutR[pixel[6]], g2 = lutG[pixel[7]], b2 = lutB[pixel[8]];
+    unsigned char r3 = lutR[pixel[9]], g3 = lutG[pixel[10]], b3 = lutB[pixel[11]];
+    pixel[0] = r0; pixel[1] = g0; pixel[2] = b0;
+    pixel[3] = r1; pixel[4] = g1; pixel[5] = b1;
+    pixel[6] = r2; pixel[7] = g2; pixel[8] = b2;
+    pixel[9] = r3; pixel[10] = g3; pixel[11] = b3;
+  }
+  scalar::applyLUT(rgb + (i * 3), pixelCount - i, lutR, lutG, lutB);
+}
+
+} // namespace PixelOps
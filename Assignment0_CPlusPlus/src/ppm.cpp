@@ -1,130 +1,312 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include "PPM.h"
+#include "PPMFormat.h"
+#include "PixelOps.h"
 
-const int MAX_COLOR_VALUE = 255;
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace PPMFormat;
+
+namespace {
+
+// Read-only memory mapping of a whole file. The mapping is released
+// when the object goes out of scope.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &fileName) {
+#ifdef _WIN32
+    m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) return;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) return;
+    m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data != nullptr) m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    m_fd = open(fileName.c_str(), O_RDONLY);
+    if (m_fd < 0) return;
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0) return;
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (addr == MAP_FAILED) return;
+    // The body is read front to back exactly once
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(addr);
+    m_size = static_cast<std::size_t>(st.st_size);
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef _WIN32
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+    if (m_data != nullptr) munmap(const_cast<char *>(m_data), m_size);
+    if (m_fd >= 0) close(m_fd);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool isOpen() const { return m_data != nullptr; }
+  const char *data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+private:
+  const char *m_data{ nullptr };
+  std::size_t m_size{ 0 };
+#ifdef _WIN32
+  HANDLE m_file{ INVALID_HANDLE_VALUE };
+  HANDLE m_mapping{ nullptr };
+#else
+  int m_fd{ -1 };
+#endif
+};
+
+// Size of the buffer P3 rows are formatted into before being written
+const std::size_t P3_WRITE_BUFFER_SIZE = 1 << 22;
+
+// Stores a * b * c in product. Returns false if it does not fit
+// in a size_t.
+bool checkedProduct(std::size_t a, std::size_t b, std::size_t c, std::size_t &product) {
+  const std::size_t limit = std::numeric_limits<std::size_t>::max();
+  if (b != 0 && a > limit / b) return false;
+  if (c != 0 && a * b > limit / c) return false;
+  product = a * b * c;
+  return true;
+}
+
+} // namespace
 
 // Constructor loads a filename with the .ppm extension
 PPM::PPM(std::string fileName) {
+  reload(fileName);
+}
+
+// Move constructor takes over the other image's pixel data
+PPM::PPM(PPM &&other) noexcept
+  : m_pixels(std::move(other.m_pixels)), m_width(other.m_width), m_height(other.m_height) {
+  other.m_width = 0;
+  other.m_height = 0;
+}
+
+// Move assignment takes over the other image's pixel data
+PPM &PPM::operator=(PPM &&other) noexcept {
+  if (this != &other) {
+    m_pixels = std::move(other.m_pixels);
+    m_width = other.m_width;
+    m_height = other.m_height;
+    other.m_width = 0;
+    other.m_height = 0;
+  }
+  return *this;
+}
+
+// Replaces the image with the one in fileName, reusing the
+// existing pixel memory when it is large enough
+bool PPM::reload(const std::string &fileName) {
+  m_pixels.clear();
+  m_width = 0;
+  m_height = 0;
+
   // Only open files with .ppm extension
-  if (fileName.substr(fileName.rfind('.')) != ".ppm") {
+  std::size_t extensionIndex = fileName.rfind('.');
+  if (extensionIndex == std::string::npos || fileName.substr(extensionIndex) != ".ppm") {
     std::cout << "Please provide a file with the .ppm extension" << std::endl;
-    return;
+    return false;
   }
 
-  // Attempt to open the file
-  std::ifstream inFile;
-  inFile.open(fileName);
-  if (!inFile.is_open()) {
+  // Attempt to map the file into memory
+  MappedFile inFile(fileName);
+  if (!inFile.isOpen()) {
     std::cout << "Unable to open file " << fileName << std::endl;
-    return;
+    return false;
   }
 
-  parsePPMFile(inFile);
-  inFile.close();
+  return parsePPMFile(inFile.data(), inFile.size());
 }
 
-// Parses a PPM file and saves its color values
-void PPM::parsePPMFile(std::ifstream &inFile) {
-  unsigned int i = 0, x = 0, y = 0;
-  int r, g, colorScale = 1;
-  std::string line;
-  while (getline(inFile, line)) {
-    // Check for comments
-    int commentIndex = line.find("#");
-    if (commentIndex != std::string::npos) {
-      line = line.substr(0, commentIndex);
-    }
+// Parses the contents of a PPM file (header and body in one pass)
+// and saves its color values. Returns false if the file is invalid.
+bool PPM::parsePPMFile(const char *data, std::size_t size) {
+  const char *p = data;
+  const char *end = data + size;
 
-    // Loop through values as tokens (handles multiple values on one line)
-    std::stringstream strstream(line);
-    std::string token;
-    while (getline(strstream, token, ' ')) {
-      if (token == "") continue; // Ignore blank tokens caused by consecutive spaces
-      if (i == 0) {
-        // Check that the PPM format is P3
-        if (token != "P3") {
-          std::cout << "File is not in PPM P3 format." << std::endl;
-          return;
-        }
-      }
-      else if (i <= 3) {
-        parseMetadata(token, i, colorScale);
-      }
-      else {
-        parseColorValues(token, i, colorScale, r, g, x, y);
-      }
-      ++i;
-    }
+  // Check that the PPM format is P3, P5 or P6
+  skipWhitespaceAndComments(p, end);
+  if (end - p < 2 || p[0] != 'P' || (p[1] != '3' && p[1] != '5' && p[1] != '6')) {
+    std::cout << "File is not in PPM P3, P5 or P6 format." << std::endl;
+    return false;
   }
-}
+  Format format = (p[1] == '3') ? P3 : (p[1] == '5') ? P5 : P6;
+  p += 2;
 
-// Use a token from the first part of the PPM file to set the width,
-// height (and initial pixel data), or max color value
-void PPM::parseMetadata(std::string token, int i, int &colorScale) {
-  int tokenInt = std::stoi(token);
-  if (i == 1) {
-    m_width = tokenInt;
+  // Width, height and max color value, with comments allowed in between
+  int width, height, maxValue;
+  if (!scanInt(p, end, width) || !scanInt(p, end, height) || !scanInt(p, end, maxValue) ||
+    width <= 0 || height <= 0 || maxValue <= 0 || maxValue > MAX_WIDE_COLOR_VALUE) {
+    std::cout << "File has an invalid PPM header." << std::endl;
+    return false;
   }
-  else if (i == 2) {
-    m_height = tokenInt;
-    m_PixelData = new unsigned char[m_width * m_height * 3];
+
+  // Check the file can hold the body before allocating the pixels
+  // the header asks for. A binary body follows one whitespace
+  // character; a P3 value takes at least a digit and the whitespace
+  // before it.
+  const std::size_t channels = (format == P5) ? 1 : 3;
+  const std::size_t bytesPerValue = (format == P3 || maxValue > MAX_COLOR_VALUE) ? 2 : 1;
+  const std::size_t remaining = static_cast<std::size_t>(end - p);
+  std::size_t bodySize;
+  if (!checkedProduct(width, height, channels * bytesPerValue, bodySize) ||
+    (format == P3 ? bodySize > remaining : bodySize >= remaining)) {
+    std::cout << "File ended before all color values were read." << std::endl;
+    return false;
   }
-  else if (i == 3) {
-    colorScale = MAX_COLOR_VALUE / tokenInt;
+  m_width = width;
+  m_height = height;
+  m_pixels.resize(pixelByteCount());
+
+  // Maps every value up to maxValue onto 0-255
+  std::vector<unsigned char> colorScale = makeColorScale(maxValue);
+
+  // A single whitespace character separates a binary header from the raster
+  bool complete = (format == P3) ?
+    parsePlainBody(p, end, colorScale) :
+    (p != end) && parseRawBody(p + 1, end, format == P5 ? 1 : 3, maxValue, colorScale);
+  if (!complete) {
+    std::cout << "File ended before all color values were read." << std::endl;
+    m_pixels.clear();
+    m_width = 0;
+    m_height = 0;
   }
+  return complete;
 }
 
-// Use a token from the body of the PPM file to store an individual
-// color value, or save a pixel if we are at the end of a triple
-void PPM::parseColorValues(std::string token, int i, int colorScale,
-  int &r, int &g, unsigned int &x, unsigned int &y) {
-  int colorIndex = (i - 4) % 3; // minus four to compensate for metadata
-  int colorValue = std::stoi(token) * colorScale;
-  if (colorIndex == 0) {
-    r = colorValue;
-  }
-  else if (colorIndex == 1) {
-    g = colorValue;
-  }
-  else if (colorIndex == 2) {
-    setPixel(x, y, r, g, colorValue);
-    if (++x == m_width) {
-      x = 0;
-      ++y;
-    }
+// Reads the whitespace separated decimal color values of a P3 body.
+// Returns false if the body is incomplete.
+bool PPM::parsePlainBody(const char *p, const char *end,
+  const std::vector<unsigned char> &colorScale) {
+  const int maxValue = static_cast<int>(colorScale.size()) - 1;
+
+  // Color values are stored in R,G,B order, so the body
+  // maps directly onto the pixel data
+  unsigned char *pixels = m_pixels.data();
+  const std::size_t valueCount = pixelByteCount();
+  for (std::size_t i = 0; i < valueCount; ++i) {
+    int colorValue;
+    if (!scanInt(p, end, colorValue)) return false;
+    pixels[i] = colorScale[colorValue < maxValue ? colorValue : maxValue];
   }
+  return true;
 }
 
-// Destructor clears any memory that has been allocated
-PPM::~PPM() {
-  delete[] m_PixelData;
+// Reads the binary raster of a P5 (1 channel) or P6 (3 channel) body.
+// Samples are one byte each, or two big-endian bytes when maxValue > 255.
+// Returns false if the body is incomplete.
+bool PPM::parseRawBody(const char *p, const char *end, int channels, int maxValue,
+  const std::vector<unsigned char> &colorScale) {
+  const std::size_t pixelCount = static_cast<std::size_t>(m_width) * m_height;
+  const std::size_t sampleSize = (maxValue > MAX_COLOR_VALUE) ? 2 : 1;
+  if (static_cast<std::size_t>(end - p) < pixelCount * channels * sampleSize) {
+    return false;
+  }
+  convertRawSamples(reinterpret_cast<const unsigned char *>(p), pixelCount, channels,
+    maxValue, colorScale, m_pixels.data());
+  return true;
 }
 
-// Saves a PPM Image to a new file
-void PPM::savePPM(std::string outputFileName) {
+// Saves a PPM Image to a new file in the given format.
+// Returns false if the file could not be written.
+bool PPM::savePPM(std::string outputFileName, Format format) {
+  if (format != P3) {
+    return saveRawPPM(outputFileName, format);
+  }
+
   std::ofstream outFile;
   outFile.open(outputFileName);
+  if (!outFile.is_open()) {
+    std::cout << "Unable to open file " << outputFileName << std::endl;
+    return false;
+  }
 
   // Print header, width, height, max color value
-  outFile << "P3" << std::endl;
-  outFile << m_width << " " << m_height << std::endl;
-  outFile << MAX_COLOR_VALUE << std::endl;
+  outFile << "P3\n" << m_width << " " << m_height << "\n" << MAX_COLOR_VALUE << "\n";
+
+  // Print color values with each row on its own line. Rows are
+  // formatted into one large buffer that is written out whenever
+  // it fills up, instead of streaming every number separately.
+  const std::size_t rowBytes = static_cast<std::size_t>(m_width) * 3;
+  const std::size_t maxRowText = (rowBytes * 4) + 1;
+  const std::size_t bufferSize = std::max<std::size_t>(P3_WRITE_BUFFER_SIZE, maxRowText);
+  std::vector<char> buffer(bufferSize);
+  char *out = buffer.data();
+  const char *flushPoint = buffer.data() + bufferSize - maxRowText;
 
-  // Print color values with each row on its own line
   for (int y = 0; y < m_height; ++y) {
-    for (int x = 0; x < m_width; ++x) {
-      int rIndex = getRIndex(x, y);
-      int r = m_PixelData[rIndex];
-      int g = m_PixelData[rIndex + 1];
-      int b = m_PixelData[rIndex + 2];
-      outFile << r << " " << g << " " << b << " ";
+    out = formatPlainRow(m_pixels.data() + (y * rowBytes), rowBytes, out);
+    if (out > flushPoint) {
+      outFile.write(buffer.data(), out - buffer.data());
+      out = buffer.data();
     }
-    outFile << std::endl;
   }
+  outFile.write(buffer.data(), out - buffer.data());
   outFile.close();
+  if (outFile.fail()) {
+    std::cout << "Unable to write file " << outputFileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Saves a binary P5 (grayscale) or P6 (RGB) image, writing the
+// whole raster with a single call. Returns false if the file could
+// not be written.
+bool PPM::saveRawPPM(const std::string &outputFileName, Format format) {
+  std::ofstream outFile(outputFileName, std::ios::binary);
+  if (!outFile.is_open()) {
+    std::cout << "Unable to open file " << outputFileName << std::endl;
+    return false;
+  }
+
+  const std::size_t pixelCount = static_cast<std::size_t>(m_width) * m_height;
+  outFile << (format == P5 ? "P5" : "P6") << "\n"
+    << m_width << " " << m_height << "\n"
+    << MAX_COLOR_VALUE << "\n";
+
+  if (format == P6) {
+    outFile.write(reinterpret_cast<const char *>(m_pixels.data()), pixelCount * 3);
+  }
+  else {
+    std::vector<unsigned char> gray(pixelCount);
+    for (std::size_t i = 0; i < pixelCount; ++i) {
+      const unsigned char *rgb = m_pixels.data() + (i * 3);
+      gray[i] = PixelOps::luma(rgb[0], rgb[1], rgb[2]);
+    }
+    outFile.write(reinterpret_cast<const char *>(gray.data()), gray.size());
+  }
+  outFile.close();
+  if (outFile.fail()) {
+    std::cout << "Unable to write file " << outputFileName << std::endl;
+    return false;
+  }
+  return true;
 }
 
 // Darken subtracts 50 from each of the red, green
@@ -132,29 +314,64 @@ void PPM::savePPM(std::string outputFileName) {
 // in the PPM. Note that no values may be less than
 // 0 in a ppm.
 void PPM::darken() {
-  for (int y = 0; y < m_height; ++y) {
-    for (int x = 0; x < m_width; ++x) {
-      int rIndex = getRIndex(x, y);
-      setPixel(x, y,
-        darkenColor(m_PixelData[rIndex]),
-        darkenColor(m_PixelData[rIndex + 1]),
-        darkenColor(m_PixelData[rIndex + 2]));
-    }
-  }
+  darkenPixels(m_pixels.data(), pixelByteCount() / 3);
 }
 
-// Subtracts 50 from an individual color component,
-// without making it go below 0
-int PPM::darkenColor(int colorValue) {
-  return (colorValue > 50) ? (colorValue - 50) : 0;
+// The darken filter on its own, for any span of R,G,B pixels
+// (for example one band of rows from a PPMReader)
+void PPM::darkenPixels(unsigned char *rgb, std::size_t pixelCount) {
+  PixelOps::subtractSaturate(rgb, pixelCount * 3, 50);
+}
+
+// Brighten adds 50 to each color component, without
+// letting any value go above 255.
+void PPM::brighten() {
+  PixelOps::addSaturate(m_pixels.data(), pixelByteCount(), 50);
+}
+
+// Inverts each color component (255 - value)
+void PPM::invert() {
+  PixelOps::invert(m_pixels.data(), pixelByteCount());
+}
+
+// Replaces each pixel with its luminance
+void PPM::grayscale() {
+  PixelOps::grayscale(m_pixels.data(), pixelByteCount() / 3);
+}
+
+// Sets each color component at or above level to 255
+// and all others to 0
+void PPM::threshold(unsigned char level) {
+  PixelOps::threshold(m_pixels.data(), pixelByteCount(), level);
+}
+
+// Maps each color component through a 256-entry table per channel
+void PPM::applyLUT(const unsigned char *lutR, const unsigned char *lutG, const unsigned char *lutB) {
+  PixelOps::applyLUT(m_pixels.data(), pixelByteCount() / 3, lutR, lutG, lutB);
+}
+
+// Filters the image with a convolution kernel
+void PPM::convolve(const Convolution::Kernel &kernel, ThreadPool *pool) {
+  if (!isLoaded()) return;
+  PixelBuffer filtered(pixelByteCount());
+  Convolution::convolve(m_pixels.data(), filtered.data(), m_width, m_height, kernel, pool);
+  m_pixels = std::move(filtered);
+}
+
+// Replaces each color component with its Sobel edge strength
+void PPM::detectEdges(ThreadPool *pool) {
+  if (!isLoaded()) return;
+  PixelBuffer edges(pixelByteCount());
+  Convolution::sobel(m_pixels.data(), edges.data(), m_width, m_height, pool);
+  m_pixels = std::move(edges);
 }
 
 // Sets a pixel to a specific R,G,B value 
 void PPM::setPixel(int x, int y, int r, int g, int b) {
-  int rIndex = getRIndex(x, y);
-  m_PixelData[rIndex] = r;
-  m_PixelData[rIndex + 1] = g;
-  m_PixelData[rIndex + 2] = b;
+  unsigned char *pixel = m_pixels.data() + getRIndex(x, y);
+  pixel[0] = r;
+  pixel[1] = g;
+  pixel[2] = b;
 }
 
 // Calculates the index of the R color component in the
@@ -162,3 +379,8 @@ void PPM::setPixel(int x, int y, int r, int g, int b) {
 int PPM::getRIndex(int x, int y) {
   return ((y * m_width) + x) * 3;
 }
+
+// Number of bytes of pixel data (3 per pixel)
+std::size_t PPM::pixelByteCount() const {
+  return static_cast<std::size_t>(m_width) * m_height * 3;
+}
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "PPMFormat.h"
+#include "PPMStream.h"
+#include "PixelOps.h"
+
+using namespace PPMFormat;
+
+namespace {
+
+// Smallest read buffer; large enough that a number never has to be
+// split across two refills
+const std::size_t MIN_BUFFER_SIZE = 64;
+
+} // namespace
+
+// Opens fileName and reads its header
+PPMReader::PPMReader(const std::string &fileName, std::size_t bufferSize)
+  : m_file(fileName, std::ios::binary),
+    m_buffer(std::max(bufferSize, MIN_BUFFER_SIZE)) {
+  m_pos = m_end = m_buffer.data();
+  if (!m_file.is_open()) {
+    std::cout << "Unable to open file " << fileName << std::endl;
+    return;
+  }
+
+  // Check that the PPM format is P3, P5 or P6
+  if (!skipSeparators() || (m_end - m_pos < 2 && !refill()) || m_end - m_pos < 2 ||
+    m_pos[0] != 'P' || (m_pos[1] != '3' && m_pos[1] != '5' && m_pos[1] != '6')) {
+    std::cout << "File is not in PPM P3, P5 or P6 format." << std::endl;
+    return;
+  }
+  m_format = (m_pos[1] == '3') ? PPM::P3 : (m_pos[1] == '5') ? PPM::P5 : PPM::P6;
+  m_pos += 2;
+
+  // Width, height and max color value, with comments allowed in between
+  if (!readInt(m_width) || !readInt(m_height) || !readInt(m_maxValue) ||
+    m_width <= 0 || m_height <= 0 || m_maxValue <= 0 || m_maxValue > MAX_WIDE_COLOR_VALUE) {
+    std::cout << "File has an invalid PPM header." << std::endl;
+    return;
+  }
+
+  // A single whitespace character separates a binary header from the raster
+  if (m_format != PPM::P3) {
+    if (m_pos == m_end && !refill()) {
+      std::cout << "File ended before all color values were read." << std::endl;
+      return;
+    }
+    ++m_pos;
+  }
+
+  m_colorScale = makeColorScale(m_maxValue);
+  m_open = true;
+}
+
+// Reads the next rowCount rows (clamped to the rows remaining) into rgb
+int PPMReader::readRows(unsigned char *rgb, int rowCount) {
+  if (!m_open) return 0;
+  rowCount = std::min(rowCount, rowsRemaining());
+  if (rowCount <= 0) return 0;
+
+  const std::size_t pixelCount = static_cast<std::size_t>(m_width) * rowCount;
+  bool complete = true;
+  if (m_format == PPM::P3) {
+    const std::size_t valueCount = pixelCount * 3;
+    const int maxValue = m_maxValue;
+    for (std::size_t i = 0; i < valueCount; ++i) {
+      int colorValue;
+      if (!readInt(colorValue)) {
+        complete = false;
+        break;
+      }
+      rgb[i] = m_colorScale[colorValue < maxValue ? colorValue : maxValue];
+    }
+  }
+  else {
+    const std::size_t channels = (m_format == PPM::P5) ? 1 : 3;
+    const std::size_t sampleSize = (m_maxValue > MAX_COLOR_VALUE) ? 2 : 1;
+    if (channels == 3 && sampleSize == 1) {
+      complete = readBytes(rgb, pixelCount * 3);
+    }
+    else {
+      m_samples.resize(pixelCount * channels * sampleSize);
+      complete = readBytes(m_samples.data(), m_samples.size());
+      if (complete) {
+        convertRawSamples(m_samples.data(), pixelCount, static_cast<int>(channels),
+          m_maxValue, m_colorScale, rgb);
+      }
+    }
+  }
+
+  if (!complete) {
+    std::cout << "File ended before all color values were read." << std::endl;
+    m_open = false;
+    return 0;
+  }
+  m_row += rowCount;
+  return rowCount;
+}
+
+// Moves unread bytes to the front of the buffer and reads more of
+// the file after them
+bool PPMReader::refill() {
+  std::size_t unread = m_end - m_pos;
+  std::memmove(m_buffer.data(), m_pos, unread);
+  m_file.read(m_buffer.data() + unread, m_buffer.size() - unread);
+  std::size_t added = static_cast<std::size_t>(m_file.gcount());
+  m_pos = m_buffer.data();
+  m_end = m_buffer.data() + unread + added;
+  return added > 0;
+}
+
+// Skips whitespace and comments, refilling the buffer as needed. A
+// comment may continue across refills, so its state is kept in a member.
+bool PPMReader::skipSeparators() {
+  for (;;) {
+    while (m_pos < m_end) {
+      char c = *m_pos;
+      if (m_inComment) {
+        m_inComment = (c != '\n');
+      }
+      else if (c == '#') {
+        m_inComment = true;
+      }
+      else if (!isSpace(c)) {
+        return true;
+      }
+      ++m_pos;
+    }
+    if (!refill()) return false;
+  }
+}
+
+// Reads the next decimal integer of the header or a P3 body
+bool PPMReader::readInt(int &value) {
+  if (!skipSeparators()) return false;
+  // Make sure the number is not cut off by the end of the buffer
+  if (static_cast<std::size_t>(m_end - m_pos) < MIN_BUFFER_SIZE / 2) {
+    refill();
+  }
+  return scanInt(m_pos, m_end, value);
+}
+
+// Copies the next count bytes of a binary body into out
+bool PPMReader::readBytes(unsigned char *out, std::size_t count) {
+  // Whatever is still buffered comes first
+  std::size_t buffered = std::min<std::size_t>(count, m_end - m_pos);
+  std::memcpy(out, m_pos, buffered);
+  m_pos += buffered;
+  count -= buffered;
+  if (count == 0) return true;
+
+  // The rest goes straight from the file to out
+  m_file.read(reinterpret_cast<char *>(out + buffered), count);
+  return static_cast<std::size_t>(m_file.gcount()) == count;
+}
+
+// Creates fileName and writes the header for a width x height image
+PPMWriter::PPMWriter(const std::string &fileName, int width, int height, PPM::Format format)
+  : m_file(fileName, format == PPM::P3 ? std::ios::out : std::ios::out | std::ios::binary),
+    m_format(format), m_width(width), m_height(height) {
+  if (!m_file.is_open()) {
+    std::cout << "Unable to open file " << fileName << std::endl;
+    return;
+  }
+  m_file << (format == PPM::P3 ? "P3" : format == PPM::P5 ? "P5" : "P6") << "\n"
+    << m_width << " " << m_height << "\n"
+    << MAX_COLOR_VALUE << "\n";
+}
+
+// Writes rowCount rows of packed R,G,B pixels
+bool PPMWriter::writeRows(const unsigned char *rgb, int rowCount) {
+  if (!m_file.is_open() || rowCount < 0 || rowCount > rowsRemaining()) return false;
+
+  const std::size_t rowBytes = static_cast<std::size_t>(m_width) * 3;
+  const std::size_t pixelCount = static_cast<std::size_t>(m_width) * rowCount;
+  if (m_format == PPM::P6) {
+    m_file.write(reinterpret_cast<const char *>(rgb), pixelCount * 3);
+  }
+  else if (m_format == PPM::P5) {
+    m_scratch.resize(pixelCount);
+    for (std::size_t i = 0; i < pixelCount; ++i) {
+      const unsigned char *pixel = rgb + (i * 3);
+      m_scratch[i] = static_cast<char>(PixelOps::luma(pixel[0], pixel[1], pixel[2]));
+    }
+    m_file.write(m_scratch.data(), pixelCount);
+  }
+  else {
+    // Same text as PPM::savePPM: one image row per line
+    m_scratch.resize(((rowBytes * 4) + 1) * rowCount);
+    char *out = m_scratch.data();
+    for (int y = 0; y < rowCount; ++y) {
+      out = formatPlainRow(rgb + (y * rowBytes), rowBytes, out);
+    }
+    m_file.write(m_scratch.data(), out - m_scratch.data());
+  }
+
+  m_row += rowCount;
+  return static_cast<bool>(m_file);
+}
+
+// Copies inputFileName to outputFileName in the given format, bandRows
+// rows at a time, passing each band through filter first
+bool streamPPM(const std::string &inputFileName, const std::string &outputFileName,
+  PPM::Format format, int bandRows, const RowFilter &filter) {
+  PPMReader reader(inputFileName);
+  if (!reader.isOpen()) return false;
+  PPMWriter writer(outputFileName, reader.getWidth(), reader.getHeight(), format);
+  if (!writer.isOpen()) return false;
+
+  bandRows = std::max(1, std::min(bandRows, reader.getHeight()));
+  std::vector<unsigned char> band(static_cast<std::size_t>(reader.getWidth()) * bandRows * 3);
+  int rows;
+  while ((rows = reader.readRows(band.data(), bandRows)) > 0) {
+    if (filter) {
+      filter(band.data(), static_cast<std::size_t>(reader.getWidth()) * rows);
+    }
+    if (!writer.writeRows(band.data(), rows)) return false;
+  }
+  return reader.rowsRemaining() == 0 && writer.rowsRemaining() == 0;
+}
@@ -0,0 +1,376 @@
+// Unit tests for the PPM library.
+// Each test returns true when it passes; the program exits with
+// a non-zero status if any test fails.
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "Convolution.h"
+#include "PixelOps.h"
+#include "PPM.h"
+#include "PPMStream.h"
+#include "ThreadPool.h"
+
+// Buffer holding every byte value several times, with an odd
+// length so the vector kernels also have a scalar tail to handle.
+std::vector<unsigned char> makeTestPixels() {
+  std::vector<unsigned char> pixels(3 * 1001);
+  unsigned int state = 7;
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    state = state * 1664525u + 1013904223u;
+    pixels[i] = (i < 256 * 3) ? static_cast<unsigned char>(i / 3) : static_cast<unsigned char>(state >> 24);
+  }
+  return pixels;
+}
+
+// Runs the vectorized and the scalar version of a kernel over the same
+// pixels, at every start offset so unaligned heads are covered too.
+bool matchesScalar(std::function<void(unsigned char *, std::size_t)> kernel,
+  std::function<void(unsigned char *, std::size_t)> reference) {
+  for (std::size_t offset = 0; offset < 3 * 8; offset += 3) {
+    std::vector<unsigned char> actual = makeTestPixels();
+    std::vector<unsigned char> expected = actual;
+    kernel(actual.data() + offset, actual.size() - offset);
+    reference(expected.data() + offset, expected.size() - offset);
+    if (actual != expected) return false;
+  }
+  return true;
+}
+
+bool unitTest0() {
+  return
+    matchesScalar(
+      [](unsigned char *p, std::size_t n) { PixelOps::subtractSaturate(p, n, 50); },
+      [](unsigned char *p, std::size_t n) { PixelOps::scalar::subtractSaturate(p, n, 50); }) &&
+    matchesScalar(
+      [](unsigned char *p, std::size_t n) { PixelOps::subtractSaturate(p, n, 255); },
+      [](unsigned char *p, std::size_t n) { PixelOps::scalar::subtractSaturate(p, n, 255); });
+}
+
+bool unitTest1() {
+  return
+    matchesScalar(
+      [](unsigned char *p, std::size_t n) { PixelOps::addSaturate(p, n, 50); },
+      [](unsigned char *p, std::size_t n) { PixelOps::scalar::addSaturate(p, n, 50); }) &&
+    matchesScalar(
+      [](unsigned char *p, std::size_t n) { PixelOps::addSaturate(p, n, 0); },
+      [](unsigned char *p, std::size_t n) { PixelOps::scalar::addSaturate(p, n, 0); });
+}
+
+bool unitTest2() {
+  return matchesScalar(
+    [](unsigned char *p, std::size_t n) { PixelOps::invert(p, n); },
+    [](unsigned char *p, std::size_t n) { PixelOps::scalar::invert(p, n); });
+}
+
+bool unitTest3() {
+  bool result = true;
+  const unsigned char levels[] = { 0, 1, 128, 255 };
+  for (unsigned char level : levels) {
+    result = result && matchesScalar(
+      [level](unsigned char *p, std::size_t n) { PixelOps::threshold(p, n, level); },
+      [level](unsigned char *p, std::size_t n) { PixelOps::scalar::threshold(p, n, level); });
+  }
+  return result;
+}
+
+bool unitTest4() {
+  return matchesScalar(
+    [](unsigned char *p, std::size_t n) { PixelOps::grayscale(p, n / 3); },
+    [](unsigned char *p, std::size_t n) { PixelOps::scalar::grayscale(p, n / 3); });
+}
+
+bool unitTest5() {
+  unsigned char lutR[256], lutG[256], lutB[256];
+  for (int i = 0; i < 256; ++i) {
+    lutR[i] = static_cast<unsigned char>(255 - i);
+    lutG[i] = static_cast<unsigned char>(i / 2);
+    lutB[i] = static_cast<unsigned char>((i * 7) & 0xFF);
+  }
+  return matchesScalar(
+    [&](unsigned char *p, std::size_t n) { PixelOps::applyLUT(p, n / 3, lutR, lutG, lutB); },
+    [&](unsigned char *p, std::size_t n) { PixelOps::scalar::applyLUT(p, n / 3, lutR, lutG, lutB); });
+}
+
+// Spot-check the reference kernels themselves
+bool unitTest6() {
+  unsigned char p[] = { 0, 49, 50, 51, 205, 206, 255 };
+  PixelOps::scalar::subtractSaturate(p, 7, 50);
+  bool result = p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 1 && p[6] == 205;
+  PixelOps::scalar::addSaturate(p, 7, 50);
+  result = result && p[0] == 50 && p[3] == 51 && p[4] == 205 && p[5] == 206 && p[6] == 255;
+
+  unsigned char white[] = { 255, 255, 255 };
+  PixelOps::scalar::grayscale(white, 1);
+  return result && white[0] == 255 && white[1] == 255 && white[2] == 255;
+}
+
+// Writes a small P3 image whose pixels all have the given color
+std::string writeSolidImage(const char *fileName, int width, int height, int value) {
+  std::ofstream outFile(fileName);
+  outFile << "P3\n" << width << " " << height << "\n255\n";
+  for (int i = 0; i < width * height * 3; ++i) {
+    outFile << value << " ";
+  }
+  return fileName;
+}
+
+// Copies are deep and independent of the original
+bool unitTest7() {
+  PPM original(writeSolidImage("tests_copy.ppm", 4, 3, 100));
+  PPM copy(original);
+  PPM assigned;
+  assigned = original;
+  copy.darken();
+  bool result =
+    copy.getWidth() == 4 && copy.getHeight() == 3 &&
+    copy.pixelData() != original.pixelData() &&
+    original.pixelData()[0] == 100 && copy.pixelData()[0] == 50 &&
+    assigned.pixelData() != original.pixelData() && assigned.pixelData()[11] == 100;
+  std::remove("tests_copy.ppm");
+  return result;
+}
+
+// Moves take over the pixel data and leave the source empty
+bool unitTest8() {
+  PPM original(writeSolidImage("tests_move.ppm", 4, 3, 100));
+  unsigned char *pixels = original.pixelData();
+  PPM moved(std::move(original));
+  bool result = moved.pixelData() == pixels && moved.getWidth() == 4 &&
+    !original.isLoaded() && original.getWidth() == 0 && original.getHeight() == 0;
+
+  PPM assigned;
+  assigned = std::move(moved);
+  result = result && assigned.pixelData() == pixels && !moved.isLoaded();
+  std::remove("tests_move.ppm");
+  return result;
+}
+
+// Reloading reuses aligned memory, and failed loads leave the image empty
+bool unitTest9() {
+  PPM image(writeSolidImage("tests_reload_big.ppm", 8, 8, 10));
+  unsigned char *pixels = image.pixelData();
+  bool result = reinterpret_cast<std::uintptr_t>(pixels) % PixelBuffer::ALIGNMENT == 0;
+
+  result = result && image.reload(writeSolidImage("tests_reload_small.ppm", 4, 4, 20)) &&
+    image.pixelData() == pixels && image.getWidth() == 4 && image.pixelData()[47] == 20;
+
+  result = result && !image.reload("tests_missing.ppm") && !image.isLoaded() &&
+    image.getWidth() == 0;
+  std::remove("tests_reload_big.ppm");
+  std::remove("tests_reload_small.ppm");
+  return result;
+}
+
+// Reads a whole file into a string
+std::string readFile(const char *fileName) {
+  std::ifstream inFile(fileName, std::ios::binary);
+  std::ostringstream contents;
+  contents << inFile.rdbuf();
+  return contents.str();
+}
+
+// Writes a P3 image with varied colors and a comment between two rows
+void writePatternImage(const char *fileName, int width, int height) {
+  std::ofstream outFile(fileName);
+  outFile << "P3\n# pattern\n" << width << " " << height << "\n255\n";
+  for (int y = 0; y < height; ++y) {
+    for (int i = 0; i < width * 3; ++i) {
+      outFile << ((y * 37) + (i * 11)) % 256 << " ";
+    }
+    outFile << (y == 1 ? "# a comment inside the body\n" : "\n");
+  }
+}
+
+// Streaming darken gives the same files as loading, darkening and saving
+// the whole image, in every output format and with band sizes that do
+// not divide the height
+bool unitTest10() {
+  writePatternImage("tests_stream.ppm", 13, 7);
+  PPM image("tests_stream.ppm");
+  image.darken();
+
+  bool result = true;
+  const PPM::Format formats[] = { PPM::P3, PPM::P5, PPM::P6 };
+  const int bandRows[] = { 1, 3, 100 };
+  for (PPM::Format format : formats) {
+    image.savePPM("tests_stream_whole.ppm", format);
+    for (int rows : bandRows) {
+      result = result &&
+        streamPPM("tests_stream.ppm", "tests_stream_band.ppm", format, rows, PPM::darkenPixels) &&
+        readFile("tests_stream_band.ppm") == readFile("tests_stream_whole.ppm");
+    }
+  }
+  std::remove("tests_stream.ppm");
+  std::remove("tests_stream_whole.ppm");
+  std::remove("tests_stream_band.ppm");
+  return result;
+}
+
+// A reader with the smallest buffer refills in the middle of numbers
+// and comments, reads binary input, and stops at a truncated body
+bool unitTest11() {
+  writePatternImage("tests_stream.ppm", 13, 7);
+  PPM image("tests_stream.ppm");
+  image.savePPM("tests_stream_p6.ppm", PPM::P6);
+
+  bool result = true;
+  const char *fileNames[] = { "tests_stream.ppm", "tests_stream_p6.ppm" };
+  for (const char *fileName : fileNames) {
+    PPMReader reader(fileName, 1);
+    std::vector<unsigned char> rgb(13 * 7 * 3);
+    int rows = 0;
+    int read;
+    while ((read = reader.readRows(rgb.data() + (rows * 13 * 3), 2)) > 0) {
+      rows += read;
+    }
+    result = result && reader.isOpen() && rows == 7 && reader.rowsRemaining() == 0 &&
+      std::equal(rgb.begin(), rgb.end(), image.pixelData());
+  }
+
+  // Cut the binary file off in its last row
+  std::string truncated = readFile("tests_stream_p6.ppm");
+  std::ofstream("tests_stream_p6.ppm", std::ios::binary) << truncated.substr(0, truncated.size() - 5);
+  PPMReader reader("tests_stream_p6.ppm");
+  std::vector<unsigned char> rgb(13 * 7 * 3);
+  result = result && reader.readRows(rgb.data(), 6) == 6 && reader.readRows(rgb.data(), 1) == 0 &&
+    !streamPPM("tests_stream_p6.ppm", "tests_stream_band.ppm", PPM::P6, 4, RowFilter());
+
+  std::remove("tests_stream.ppm");
+  std::remove("tests_stream_p6.ppm");
+  std::remove("tests_stream_band.ppm");
+  return result;
+}
+
+// Largest difference between two equally sized buffers
+int maxDifference(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b) {
+  int result = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    result = std::max(result, std::abs(a[i] - b[i]));
+  }
+  return result;
+}
+
+// Box and separable convolution agree with the direct 2D sum (up to
+// float rounding), with and without a pool, including radii larger
+// than the image
+bool unitTest12() {
+  const int width = 37, height = 23;
+  std::vector<unsigned char> src = makeTestPixels();
+  src.resize(width * height * 3);
+  std::vector<unsigned char> naive(src.size()), fast(src.size());
+  ThreadPool pool(3);
+
+  std::vector<float> column, row;
+  bool result =
+    Convolution::separate(Convolution::gaussianKernel(4), column, row) &&
+    Convolution::separate(Convolution::blurKernel(), column, row) &&
+    Convolution::separate(Convolution::sobelXKernel(), column, row) &&
+    !Convolution::separate(Convolution::sharpenKernel(), column, row) &&
+    Convolution::isBox(Convolution::boxKernel(3)) &&
+    !Convolution::isBox(Convolution::blurKernel());
+
+  const Convolution::Kernel kernels[] = {
+    Convolution::boxKernel(1), Convolution::boxKernel(5), Convolution::boxKernel(30),
+    Convolution::gaussianKernel(3), Convolution::gaussianKernel(25), Convolution::sobelYKernel()
+  };
+  for (const Convolution::Kernel &kernel : kernels) {
+    Convolution::convolve(src.data(), naive.data(), width, height, kernel, nullptr, Convolution::Naive);
+    Convolution::convolve(src.data(), fast.data(), width, height, kernel);
+    result = result && maxDifference(naive, fast) <= 1;
+    Convolution::convolve(src.data(), fast.data(), width, height, kernel, &pool);
+    result = result && maxDifference(naive, fast) <= 1;
+    Convolution::convolve(src.data(), fast.data(), width, height, kernel, &pool, Convolution::Separable);
+    result = result && maxDifference(naive, fast) <= 1;
+  }
+  return result;
+}
+
+// The FBOFrag.glsl kernels and edge detection on simple images
+bool unitTest13() {
+  PPM image(writeSolidImage("tests_convolve.ppm", 9, 5, 120));
+  image.convolve(Convolution::blurKernel());
+  bool result = image.pixelData()[0] == 120 && image.pixelData()[134] == 120;
+  image.convolve(Convolution::sharpenKernel());
+  result = result && image.pixelData()[67] == 120;
+  image.detectEdges();
+  result = result && image.pixelData()[0] == 0 && image.pixelData()[134] == 0;
+
+  // A vertical edge: dark left half, bright right half
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 9; ++x) {
+      int value = (x < 4) ? 0 : 100;
+      image.setPixel(x, y, value, value, value);
+    }
+  }
+  PPM sharpened(image);
+  sharpened.convolve(Convolution::sharpenKernel());
+  image.detectEdges();
+  result = result &&
+    image.pixelData()[(2 * 9 + 0) * 3] == 0 && image.pixelData()[(2 * 9 + 3) * 3] == 255 &&
+    image.pixelData()[(2 * 9 + 8) * 3] == 0 &&
+    sharpened.pixelData()[(2 * 9 + 3) * 3] == 0 && sharpened.pixelData()[(2 * 9 + 4) * 3] == 255 &&
+    sharpened.pixelData()[(2 * 9 + 8) * 3] == 100;
+  std::remove("tests_convolve.ppm");
+  return result;
+}
+
+// Headers claiming more pixels than the file holds are rejected
+// before the pixels are allocated
+bool unitTest14() {
+  const char *headers[] = {
+    "P6\n60000 60000\n255\nab",
+    "P5\n60000 60000\n65535\nab",
+    "P6\n2147483647 2147483647\n65535\nab",
+    "P6\n2 2\n255\n0123456789a",
+    "P3\n30000 30000\n255\n1 2 3",
+    "P3\n2147483647 2147483647\n255\n1 2 3",
+    "P3\n2 1\n255\n1 2 3 4 5"
+  };
+  bool result = true;
+  PPM image(writeSolidImage("tests_truncated.ppm", 2, 2, 10));
+  for (const char *header : headers) {
+    std::ofstream("tests_truncated.ppm", std::ios::binary) << header;
+    result = result && !image.reload("tests_truncated.ppm") && !image.isLoaded();
+  }
+  // Six one-digit P3 values need no more than twelve bytes
+  std::ofstream("tests_truncated.ppm", std::ios::binary) << "P3 2 1 255 1 2 3 4 5 6";
+  result = result && image.reload("tests_truncated.ppm") && image.pixelData()[5] == 6;
+  std::remove("tests_truncated.ppm");
+  return result;
+}
+
+// Saving reports whether the file was written, in every format
+bool unitTest15() {
+  PPM image(writeSolidImage("tests_save.ppm", 3, 2, 40));
+  bool result = true;
+  const PPM::Format formats[] = { PPM::P3, PPM::P5, PPM::P6 };
+  for (PPM::Format format : formats) {
+    result = result && image.savePPM("tests_save.ppm", format) &&
+      !image.savePPM("tests_missing_directory/tests_save.ppm", format);
+  }
+  std::remove("tests_save.ppm");
+  return result;
+}
+
+int main() {
+  bool results[] = {
+    unitTest0(), unitTest1(), unitTest2(), unitTest3(),
+    unitTest4(), unitTest5(), unitTest6(), unitTest7(),
+    unitTest8(), unitTest9(), unitTest10(), unitTest11(),
+    unitTest12(), unitTest13(), unitTest14(),
+    unitTest15()
+  };
+
+  // Run 'unit tests'
+  for (std::size_t i = 0; i < sizeof(results) / sizeof(results[0]); ++i) {
+    std::cout << "Passed " << i << ": " << results[i] << " \n";
+  }
+
+  return std::all_of(std::begin(results), std::end(results), [](bool r) { return r; }) ? 0 : 1;
+}
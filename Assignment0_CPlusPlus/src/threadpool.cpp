@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "ThreadPool.h"
+
+// Starts threadCount workers (at least one)
+ThreadPool::ThreadPool(unsigned int threadCount) {
+  if (threadCount == 0) threadCount = 1;
+  for (unsigned int i = 0; i < threadCount; ++i) {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+// Finishes all queued tasks, then joins the workers
+ThreadPool::~ThreadPool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_taskAvailable.notify_all();
+  for (std::thread &worker : m_workers) {
+    worker.join();
+  }
+}
+
+// Queues a task to run on a worker
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+    ++m_unfinished;
+  }
+  m_taskAvailable.notify_one();
+}
+
+// Blocks until every submitted task has finished
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_taskFinished.wait(lock, [this]() { return m_unfinished == 0; });
+}
+
+// Calls body(begin, end) over [0, count) in chunks of chunkSize,
+// spreading the chunks over the pool, and returns once all are done
+void ThreadPool::parallelFor(std::size_t count, std::size_t chunkSize,
+  const std::function<void(std::size_t, std::size_t)> &body) {
+  if (chunkSize == 0) chunkSize = 1;
+  const std::size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+  if (chunkCount <= 1) {
+    if (count > 0) body(0, count);
+    return;
+  }
+
+  // Chunks are claimed from a shared counter by the calling thread and
+  // by helper tasks. A helper that only starts after every chunk is
+  // claimed returns without touching body, so the caller never has to
+  // wait on tasks that are still queued.
+  struct Progress {
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<std::size_t> done{ 0 };
+  };
+  std::shared_ptr<Progress> progress = std::make_shared<Progress>();
+  auto work = [progress, &body, count, chunkSize, chunkCount]() {
+    std::size_t chunk;
+    while ((chunk = progress->next++) < chunkCount) {
+      std::size_t begin = chunk * chunkSize;
+      body(begin, std::min(begin + chunkSize, count));
+      ++progress->done;
+    }
+  };
+
+  std::size_t helperCount = std::min<std::size_t>(m_workers.size(), chunkCount - 1);
+  for (std::size_t i = 0; i < helperCount; ++i) {
+    submit(work);
+  }
+  work();
+
+  // Only chunks already running on other threads are left
+  while (progress->done < chunkCount) {
+    std::this_thread::yield();
+  }
+}
+
+// Loop each worker runs until the pool shuts down
+void ThreadPool::workerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+      if (m_tasks.empty()) return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      --m_unfinished;
+    }
+    m_taskFinished.notify_all();
+  }
+}
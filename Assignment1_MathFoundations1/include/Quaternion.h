@@ -0,0 +1,10 @@
+// Assignment1 uses the shared MathLib Quaternion as it is.
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "Matrix4f.h"
+#include "MathLib/Quaternion.h"
+
+using MathLib::Quaternion;
+
+#endif
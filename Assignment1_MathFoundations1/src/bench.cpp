@@ -0,0 +1,246 @@
+// Microbenchmarks for Vector4f and Matrix4f.
+//
+// Built twice by CMake: MathBench uses the SSE code paths and
+// MathBenchScalar the plain scalar ones (MATH_NO_SIMD), so running
+// both shows the gain. glm is timed alongside as a reference.
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "Vector4f.h"
+#include "Matrix4f.h"
+#include "Quaternion.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace {
+
+const int COUNT = 1024;
+const int REPEATS = 20000;
+
+// Keeps results alive so the work is not optimized away
+volatile float sink;
+
+template <typename Function>
+double nsPerOp(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < REPEATS; ++repeat) {
+    function();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / (double(REPEATS) * COUNT);
+}
+
+float value(int i) {
+  return static_cast<float>((i * 37) % 101) / 17.0f - 2.5f;
+}
+
+} // namespace
+
+int main() {
+  std::vector<Vector4f> vectors(COUNT), results(COUNT);
+  std::vector<Matrix4f> matrices(COUNT), products(COUNT);
+  std::vector<glm::vec4> glmVectors(COUNT), glmResults(COUNT);
+  std::vector<glm::mat4> glmMatrices(COUNT), glmProducts(COUNT);
+  for (int i = 0; i < COUNT; ++i) {
+    vectors[i] = Vector4f(value(i), value(i + 1), value(i + 2), 1.0f);
+    glmVectors[i] = glm::vec4(vectors[i].x, vectors[i].y, vectors[i].z, vectors[i].w);
+    for (int j = 0; j < 16; ++j) {
+      matrices[i](j / 4, j % 4) = value(i + j);
+      glmMatrices[i][j % 4][j / 4] = value(i + j);
+    }
+  }
+  const Matrix4f M = matrices[7];
+  const glm::mat4 G = glmMatrices[7];
+
+#ifdef MATH_SSE
+  std::printf("Vector4f/Matrix4f with SSE\n");
+#else
+  std::printf("Vector4f/Matrix4f scalar (MATH_NO_SIMD)\n");
+#endif
+  std::printf("%-20s %10s %10s\n", "operation", "ns/op", "glm ns/op");
+
+  double ours = nsPerOp([&]() {
+    float sum = 0.0f;
+    for (int i = 0; i < COUNT; ++i) sum += Dot(vectors[i], vectors[COUNT - 1 - i]);
+    sink = sum;
+  });
+  double theirs = nsPerOp([&]() {
+    float sum = 0.0f;
+    for (int i = 0; i < COUNT; ++i) sum += glm::dot(glmVectors[i], glmVectors[COUNT - 1 - i]);
+    sink = sum;
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Dot", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) results[i] = Normalize(vectors[i]);
+    sink = results[COUNT / 2].x;
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmResults[i] = glm::normalize(glmVectors[i]);
+    sink = glmResults[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Normalize", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) results[i] = M * vectors[i];
+    sink = results[COUNT / 2].x;
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmResults[i] = G * glmVectors[i];
+    sink = glmResults[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Matrix * Vector", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    TransformPoints(M, vectors.data(), results.data(), COUNT);
+    sink = results[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f\n", "TransformPoints", ours);
+
+  std::vector<float> x(COUNT), y(COUNT), z(COUNT), w(COUNT);
+  std::vector<float> outX(COUNT), outY(COUNT), outZ(COUNT), outW(COUNT);
+  for (int i = 0; i < COUNT; ++i) {
+    x[i] = vectors[i].x;
+    y[i] = vectors[i].y;
+    z[i] = vectors[i].z;
+    w[i] = vectors[i].w;
+  }
+  ours = nsPerOp([&]() {
+    TransformPoints(M, x.data(), y.data(), z.data(), w.data(),
+      outX.data(), outY.data(), outZ.data(), outW.data(), COUNT);
+    sink = outX[COUNT / 2];
+  });
+  std::printf("%-20s %10.2f\n", "TransformPoints SoA", ours);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = M * matrices[i];
+    sink = products[COUNT / 2](1, 1);
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmProducts[i] = G * glmMatrices[i];
+    sink = glmProducts[COUNT / 2][1][1];
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Matrix * Matrix", ours, theirs);
+
+  // Affine matrices (bottom row 0,0,0,1) so every inverse applies
+  for (int i = 0; i < COUNT; ++i) {
+    matrices[i](0, 0) += 4.0f;
+    matrices[i](1, 1) += 4.0f;
+    matrices[i](2, 2) += 4.0f;
+    matrices[i](3, 0) = 0.0f;
+    matrices[i](3, 1) = 0.0f;
+    matrices[i](3, 2) = 0.0f;
+    matrices[i](3, 3) = 1.0f;
+    for (int j = 0; j < 16; ++j) {
+      glmMatrices[i][j % 4][j / 4] = matrices[i](j / 4, j % 4);
+    }
+  }
+  std::vector<glm::mat3> glmNormals(COUNT);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = Inverse(matrices[i]);
+    sink = products[COUNT / 2](1, 1);
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmProducts[i] = glm::inverse(glmMatrices[i]);
+    sink = glmProducts[COUNT / 2][1][1];
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Inverse", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = AffineInverse(matrices[i]);
+    sink = products[COUNT / 2](1, 1);
+  });
+  std::printf("%-20s %10.2f\n", "AffineInverse", ours);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = RigidInverse(matrices[i]);
+    sink = products[COUNT / 2](1, 1);
+  });
+  std::printf("%-20s %10.2f\n", "RigidInverse", ours);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = NormalMatrix(matrices[i]);
+    sink = products[COUNT / 2](1, 1);
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmNormals[i] = glm::inverseTranspose(glm::mat3(glmMatrices[i]));
+    sink = glmNormals[COUNT / 2][1][1];
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "NormalMatrix", ours, theirs);
+
+  std::vector<Quaternion> rotations(COUNT), composed(COUNT);
+  std::vector<glm::quat> glmRotations(COUNT), glmComposed(COUNT);
+  for (int i = 0; i < COUNT; ++i) {
+    rotations[i] = Quaternion::MakeEulerRotation(value(i), value(i + 1), value(i + 2));
+    glmRotations[i] = glm::quat(rotations[i].w, rotations[i].x, rotations[i].y, rotations[i].z);
+  }
+  const Quaternion Q = rotations[7];
+  const glm::quat glmQ = glmRotations[7];
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) composed[i] = Q * rotations[i];
+    sink = composed[COUNT / 2].x;
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmComposed[i] = glmQ * glmRotations[i];
+    sink = glmComposed[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Quaternion * Quat", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) composed[i] = Slerp(Q, rotations[i], 0.3f);
+    sink = composed[COUNT / 2].x;
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmComposed[i] = glm::slerp(glmQ, glmRotations[i], 0.3f);
+    sink = glmComposed[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "Slerp", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) composed[i] = Nlerp(Q, rotations[i], 0.3f);
+    sink = composed[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f\n", "Nlerp", ours);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) products[i] = RotationMatrix(rotations[i]);
+    sink = products[COUNT / 2](1, 1);
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) glmProducts[i] = glm::mat4_cast(glmRotations[i]);
+    sink = glmProducts[COUNT / 2][1][1];
+  });
+  std::printf("%-20s %10.2f %10.2f\n", "RotationMatrix", ours, theirs);
+
+  // Building a rotation from three angles: one quaternion against
+  // three axis matrices multiplied together
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) composed[i] = Quaternion::MakeEulerRotation(vectors[i].x, vectors[i].y, vectors[i].z);
+    sink = composed[COUNT / 2].x;
+  });
+  theirs = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) {
+      products[i] = Matrix4f::MakeRotationZ(vectors[i].z) *
+        (Matrix4f::MakeRotationY(vectors[i].y) * Matrix4f::MakeRotationX(vectors[i].x));
+    }
+    sink = products[COUNT / 2](1, 1);
+  });
+  std::printf("%-20s %10.2f %10.2f (3 Matrix4f rotations)\n", "MakeEulerRotation", ours, theirs);
+
+  ours = nsPerOp([&]() {
+    for (int i = 0; i < COUNT; ++i) results[i] = Rotate(Q, vectors[i]);
+    sink = results[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f\n", "Rotate", ours);
+
+  ours = nsPerOp([&]() {
+    RotateVectors(Q, vectors.data(), results.data(), COUNT);
+    sink = results[COUNT / 2].x;
+  });
+  std::printf("%-20s %10.2f\n", "RotateVectors", ours);
+  return 0;
+}
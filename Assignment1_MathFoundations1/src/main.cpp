@@ -1,7 +1,11 @@
 // Includes for the assignment
 #include "Vector4f.h"
 #include "Matrix4f.h"
+#include "Quaternion.h"
+#include <cfloat>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 // Tests for comparing our library
 // You may compare your operations against the glm library
@@ -9,6 +13,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 bool areVectorsEqual(Vector4f a, glm::vec4 b) {
   return
@@ -252,6 +258,283 @@ bool unitTest12() {
     areMatricesEqual(zRotation, glmZRotation));
 }
 
+// Non-integer values, so the order of additions matters
+bool unitTest13() {
+  Matrix4f M(
+    0.3f, -1.7f, 2.9f, 0.1f,
+    1.1f, 0.7f, -0.2f, 3.3f,
+    -2.4f, 0.9f, 1.3f, 0.6f,
+    0.05f, 0.15f, -0.35f, 1.0f
+  );
+  glm::mat4 G;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      G[j][i] = M(i, j);
+    }
+  }
+  Vector4f v(0.7f, -1.3f, 2.1f, 1.0f);
+  glm::vec4 glmV(0.7f, -1.3f, 2.1f, 1.0f);
+
+  Vector4f n = Normalize(v);
+  glm::vec4 glmN = glm::normalize(glmV);
+
+  return
+    alignof(Vector4f) == 16 && alignof(Matrix4f) == 16 &&
+    areVectorsEqual(M * v, G * glmV) &&
+    Dot(v, M[1]) == glm::dot(glmV, G[1]) &&
+    std::fabs(n.x - glmN.x) < 1e-6f && std::fabs(n.y - glmN.y) < 1e-6f &&
+    std::fabs(n.z - glmN.z) < 1e-6f && std::fabs(n.w - glmN.w) < 1e-6f;
+}
+
+// True when r is M * v up to rounding. Each component may be off by
+// a few float epsilons of the sum of its terms' magnitudes, since
+// the compiler may fuse multiplies and adds (FMA) in one path and
+// not in another.
+bool isTransformOf(const Matrix4f &M, const Vector4f &v, const Vector4f &r) {
+  const float p[4] = { v.x, v.y, v.z, v.w };
+  const float got[4] = { r.x, r.y, r.z, r.w };
+  for (int i = 0; i < 4; ++i) {
+    float expected = 0, scale = 0;
+    for (int j = 0; j < 4; ++j) {
+      expected += M(i, j) * p[j];
+      scale += std::fabs(M(i, j) * p[j]);
+    }
+    if (std::fabs(got[i] - expected) > 4 * FLT_EPSILON * scale) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Batch transforms give the same results as M * v, including the
+// vertices left over after the last full block
+bool unitTest14() {
+  Matrix4f M(
+    0.3f, -1.7f, 2.9f, 0.1f,
+    1.1f, 0.7f, -0.2f, 3.3f,
+    -2.4f, 0.9f, 1.3f, 0.6f,
+    0.05f, 0.15f, -0.35f, 1.0f
+  );
+  const std::size_t n = 19;
+  std::vector<Vector4f> points(n), transformed(n);
+  std::vector<float> x(n), y(n), z(n), w(n), outX(n), outY(n), outZ(n), outW(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    points[i] = Vector4f(0.1f * i, 1.5f - (0.3f * i), 0.7f * i - 2.0f, (i % 3 == 0) ? 1.0f : 0.5f);
+    x[i] = points[i].x;
+    y[i] = points[i].y;
+    z[i] = points[i].z;
+    w[i] = points[i].w;
+  }
+
+  bool result = true;
+  TransformPoints(M, points.data(), transformed.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    result = result && isTransformOf(M, points[i], transformed[i]);
+  }
+
+  TransformPoints(M, x.data(), y.data(), z.data(), w.data(),
+    outX.data(), outY.data(), outZ.data(), outW.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    result = result && isTransformOf(M, points[i], Vector4f(outX[i], outY[i], outZ[i], outW[i]));
+  }
+
+  // Positions with an implied w of 1, transformed in place
+  TransformPoints(M, x.data(), y.data(), z.data(), x.data(), y.data(), z.data(), w.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    Vector4f position(points[i].x, points[i].y, points[i].z, 1.0f);
+    result = result && isTransformOf(M, position, Vector4f(x[i], y[i], z[i], w[i]));
+  }
+
+  // In place on an array of vectors
+  std::vector<Vector4f> original = points;
+  TransformPoints(M, points.data(), points.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    result = result && isTransformOf(M, original[i], points[i]);
+  }
+  return result;
+}
+
+// Matrices built at compile time
+bool unitTest15() {
+  constexpr Matrix4f scale = Matrix4f::MakeScale(2.0f, 3.0f, 4.0f);
+  constexpr Vector4f scaled = Matrix4f::MakeIdentity() * (scale * Vector4f(1, 1, 1, 1));
+  static_assert(scaled.x == 2 && scaled.y == 3 && scaled.z == 4 && scaled.w == 1, "scale");
+
+  constexpr Matrix4f shear(
+    1, 5, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1
+  );
+  constexpr Matrix4f product = scale * shear;
+  static_assert(product(1, 0) == 10 && Transpose(product)(0, 1) == 10, "product");
+  static_assert(Magnitude(Vector4f(3, 4, 0, 0)) == 5, "magnitude");
+  static_assert(Dot(CrossProduct(Vector4f(1, 0, 0, 0), Vector4f(0, 1, 0, 0)), Vector4f(0, 0, 1, 0)) == 1, "cross");
+
+  // Baked rotations agree with the ones built at run time
+  constexpr float angles[] = { -7.0f, -1.0f, 0.0f, 0.35f, 2.0f, 20.0f };
+  constexpr Matrix4f bakedRotations[] = {
+    Matrix4f::MakeRotationX(angles[0]) * Matrix4f::MakeRotationY(angles[0]),
+    Matrix4f::MakeRotationX(angles[1]) * Matrix4f::MakeRotationY(angles[1]),
+    Matrix4f::MakeRotationX(angles[2]) * Matrix4f::MakeRotationY(angles[2]),
+    Matrix4f::MakeRotationX(angles[3]) * Matrix4f::MakeRotationY(angles[3]),
+    Matrix4f::MakeRotationX(angles[4]) * Matrix4f::MakeRotationY(angles[4]),
+    Matrix4f::MakeRotationZ(ConstMath::Radians(angles[5]))
+  };
+  bool result = true;
+  for (int k = 0; k < 6; ++k) {
+    Matrix4f rotation = (k < 5) ?
+      Matrix4f::MakeRotationX(angles[k]) * Matrix4f::MakeRotationY(angles[k]) :
+      Matrix4f::MakeRotationZ(glm::radians(angles[k]));
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        result = result && std::fabs(bakedRotations[k](i, j) - rotation(i, j)) <= 1e-7f;
+      }
+    }
+  }
+  return result;
+}
+
+// Largest difference between the entries of A and B
+float maxDifference(const Matrix4f &A, const glm::mat4 &B) {
+  float result = 0.0f;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      result = std::fmax(result, std::fabs(A(i, j) - B[j][i]));
+    }
+  }
+  return result;
+}
+
+// Inverses agree with glm, and the specialized ones with the general one
+bool unitTest16() {
+  Matrix4f M(
+    0.3f, -1.7f, 2.9f, 0.1f,
+    1.1f, 0.7f, -0.2f, 3.3f,
+    -2.4f, 0.9f, 1.3f, 0.6f,
+    0.05f, 0.15f, -0.35f, 1.0f
+  );
+  glm::mat4 G;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      G[j][i] = M(i, j);
+    }
+  }
+  bool result =
+    std::fabs(Determinant(M) - glm::determinant(G)) < 1e-4f &&
+    maxDifference(Inverse(M), glm::inverse(G)) < 1e-5f &&
+    maxDifference(Inverse(M) * M, glm::mat4(1.0f)) < 1e-5f;
+
+  // Rotation and translation only, then with non-uniform scale and shear
+  glm::mat4 glmRigid = glm::translate(glm::vec3(2.0f, -3.5f, 0.25f)) *
+    glm::rotate(0.4f, glm::vec3(1.0f, 0.0f, 0.0f)) * glm::rotate(-1.2f, glm::vec3(0.0f, 0.0f, 1.0f));
+  glm::mat4 glmAffine = glmRigid * glm::scale(glm::vec3(0.5f, 3.0f, 1.5f));
+  glmAffine[1][0] += 0.3f;
+  Matrix4f rigid, affine;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      rigid(i, j) = glmRigid[j][i];
+      affine(i, j) = glmAffine[j][i];
+    }
+  }
+  result = result &&
+    maxDifference(RigidInverse(rigid), glm::inverse(glmRigid)) < 1e-5f &&
+    maxDifference(AffineInverse(rigid), glm::inverse(glmRigid)) < 1e-5f &&
+    maxDifference(AffineInverse(affine), glm::inverse(glmAffine)) < 1e-5f;
+
+  glm::mat4 glmNormal(glm::inverseTranspose(glm::mat3(glmAffine)));
+  result = result && maxDifference(NormalMatrix(affine), glmNormal) < 1e-5f;
+
+  // A normal of the plane x = y stays perpendicular to it after scaling
+  Matrix4f squash = Matrix4f::MakeScale(1.0f, 4.0f, 1.0f);
+  Vector4f normal = NormalMatrix(squash) * Vector4f(1, -1, 0, 0);
+  Vector4f along = squash * Vector4f(1, 1, 0, 0);
+  result = result && Dot(normal, along) == 0.0f;
+
+  // The scalar path, evaluated at compile time
+  constexpr Matrix4f scale = Matrix4f::MakeScale(2.0f, 4.0f, 8.0f);
+  constexpr Matrix4f inverseScale = Inverse(scale);
+  static_assert(inverseScale(0, 0) == 0.5f && inverseScale(1, 1) == 0.25f &&
+    inverseScale(2, 2) == 0.125f && inverseScale(3, 3) == 1.0f, "inverse");
+  static_assert(Determinant(scale) == 64.0f, "determinant");
+  static_assert(AffineInverse(scale)(2, 2) == 0.125f && NormalMatrix(scale)(1, 1) == 0.25f, "affine");
+  return result;
+}
+
+bool areQuaternionsClose(const Quaternion &a, const glm::quat &b) {
+  return
+    std::fabs(a.x - b.x) < 1e-6f && std::fabs(a.y - b.y) < 1e-6f &&
+    std::fabs(a.z - b.z) < 1e-6f && std::fabs(a.w - b.w) < 1e-6f;
+}
+
+// Quaternions agree with glm::quat and with the rotation matrices
+bool unitTest17() {
+  Vector4f axis = Normalize(Vector4f(0.3f, -1.2f, 0.8f, 0.0f));
+  glm::vec3 glmAxis(axis.x, axis.y, axis.z);
+  Quaternion a = Quaternion::MakeRotation(axis, 1.1f);
+  Quaternion b = Quaternion::MakeRotationY(-2.3f);
+  glm::quat glmA = glm::angleAxis(1.1f, glmAxis);
+  glm::quat glmB = glm::angleAxis(-2.3f, glm::vec3(0, 1, 0));
+
+  Matrix4f rotation = RotationMatrix(a * b);
+  glm::mat4 glmRotation = glm::mat4_cast(glmA * glmB);
+  Vector4f v(0.7f, -1.3f, 2.1f, 1.0f);
+  Vector4f rotated = Rotate(a, v);
+  glm::vec3 glmRotated = glmA * glm::vec3(v.x, v.y, v.z);
+
+  bool result =
+    areQuaternionsClose(a, glmA) &&
+    areQuaternionsClose(a * b, glmA * glmB) &&
+    areQuaternionsClose(Slerp(a, b, 0.3f), glm::slerp(glmA, glmB, 0.3f)) &&
+    std::fabs(rotated.x - glmRotated.x) < 1e-5f && std::fabs(rotated.y - glmRotated.y) < 1e-5f &&
+    std::fabs(rotated.z - glmRotated.z) < 1e-5f && rotated.w == v.w &&
+    areQuaternionsClose(Conjugate(a) * a, glm::quat(1, 0, 0, 0));
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      result = result && std::fabs(rotation(i, j) - glmRotation[j][i]) < 1e-6f;
+    }
+  }
+
+  // Back from a matrix, for each branch of MakeFromMatrix (q and -q
+  // are the same rotation)
+  const Quaternion samples[] = {
+    a, b, Quaternion::MakeRotationX(3.0f), Quaternion::MakeRotationY(3.0f), Quaternion::MakeRotationZ(3.0f)
+  };
+  for (const Quaternion &q : samples) {
+    Quaternion back = Quaternion::MakeFromMatrix(RotationMatrix(q));
+    result = result && std::fabs(std::fabs(Dot(back, q)) - 1.0f) < 1e-6f;
+  }
+
+  // Euler angles match the composed axis rotations
+  Quaternion euler = Quaternion::MakeEulerRotation(0.4f, -1.2f, 2.5f);
+  Quaternion composed = Quaternion::MakeRotationZ(2.5f) * Quaternion::MakeRotationY(-1.2f) *
+    Quaternion::MakeRotationX(0.4f);
+  result = result && std::fabs(Dot(euler, composed) - 1.0f) < 1e-6f;
+
+  // Interpolation takes the shorter path and stays unit length
+  Quaternion flipped(-b.x, -b.y, -b.z, -b.w);
+  Quaternion halfway = Nlerp(a, flipped, 0.5f);
+  result = result && std::fabs(Dot(halfway, halfway) - 1.0f) < 1e-6f &&
+    std::fabs(Dot(halfway, Slerp(a, b, 0.5f)) - 1.0f) < 1e-6f;
+
+  // The batch rotation gives the same vectors as Rotate
+  std::vector<Vector4f> points(7), out(7);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    points[i] = Vector4f(0.5f * i, 1.0f - i, 0.25f * i * i, (i % 2 == 0) ? 1.0f : 0.0f);
+  }
+  RotateVectors(a, points.data(), out.data(), points.size());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    Vector4f expected = Rotate(a, points[i]);
+    result = result && Magnitude(out[i] - expected) < 1e-5f && out[i].w == points[i].w;
+  }
+
+  // Built at compile time
+  constexpr Quaternion quarterTurn = Quaternion::MakeRotationZ(static_cast<float>(ConstMath::PI / 2.0));
+  constexpr Vector4f turned = Rotate(quarterTurn, Vector4f(1, 0, 0, 1));
+  static_assert(turned.y > 0.999999f && turned.x < 1e-6f && turned.x > -1e-6f, "rotate");
+  return result;
+}
+
 int main() {
   // Run 'unit tests'
   std::cout << "Passed 0: " << unitTest0() << " \n";
@@ -267,6 +550,11 @@ int main() {
   std::cout << "Passed 10: " << unitTest10() << " \n";
   std::cout << "Passed 11: " << unitTest11() << " \n";
   std::cout << "Passed 12: " << unitTest12() << " \n";
+  std::cout << "Passed 13: " << unitTest13() << " \n";
+  std::cout << "Passed 14: " << unitTest14() << " \n";
+  std::cout << "Passed 15: " << unitTest15() << " \n";
+  std::cout << "Passed 16: " << unitTest16() << " \n";
+  std::cout << "Passed 17: " << unitTest17() << " \n";
 
   return 0;
 }
@@ -0,0 +1,511 @@
+// Randomized differential check of Vector4f, Matrix4f and Quaternion
+// against glm.
+//
+// Every operation runs on fresh random inputs in batches, and each
+// result is compared with glm's. The error is measured in units in the
+// last place (ULPs) of the largest component of glm's result, so
+// values near zero are not judged against their own tiny ULP. Sums of
+// products (Dot, CrossProduct, Matrix * Vector, Determinant) are
+// measured against the magnitude of the terms they add instead, since
+// those can cancel to a result much smaller than any of them. Both
+// sides are timed on the same batches, giving ns/op for each.
+//
+//   ./MathCheck [--samples N] [--seed S] [--csv]
+//               [--baseline results.csv] [--max-slowdown F]
+//
+// --csv prints one line per operation for scripts to read. With
+// --baseline, an operation fails if it is more than F times (default
+// 1.5) slower than the ns/op recorded in an earlier --csv run.
+// The exit code is 1 if any operation fails.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Vector4f.h"
+#include "Matrix4f.h"
+#include "Quaternion.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace {
+
+const int BATCH = 4096;
+
+// Random inputs shared by every check in a batch, with the glm copy
+// of each alongside
+struct Inputs {
+  std::vector<Vector4f> a, b;
+  std::vector<glm::vec4> glmA, glmB;
+  // Any entries
+  std::vector<Matrix4f> M, N;
+  std::vector<glm::mat4> glmM, glmN;
+  // Affine (bottom row 0,0,0,1) with a dominant diagonal, so well
+  // conditioned
+  std::vector<Matrix4f> affine;
+  std::vector<glm::mat4> glmAffine;
+  // Rotation plus translation
+  std::vector<Matrix4f> rigid;
+  std::vector<glm::mat4> glmRigid;
+  // Unit quaternions
+  std::vector<Quaternion> p, q;
+  std::vector<glm::quat> glmP, glmQ;
+  std::vector<float> s, t;
+
+  Inputs()
+    : a(BATCH), b(BATCH), glmA(BATCH), glmB(BATCH),
+      M(BATCH), N(BATCH), glmM(BATCH), glmN(BATCH),
+      affine(BATCH), glmAffine(BATCH), rigid(BATCH), glmRigid(BATCH),
+      p(BATCH), q(BATCH), glmP(BATCH), glmQ(BATCH), s(BATCH), t(BATCH) {
+  }
+};
+
+glm::vec4 toGlm(const Vector4f &v) {
+  return glm::vec4(v.x, v.y, v.z, v.w);
+}
+
+glm::mat4 toGlm(const Matrix4f &M) {
+  glm::mat4 G;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      G[j][i] = M(i, j);
+    }
+  }
+  return G;
+}
+
+glm::quat toGlm(const Quaternion &q) {
+  return glm::quat(q.w, q.x, q.y, q.z);
+}
+
+void generate(Inputs &in, std::mt19937 &random) {
+  std::uniform_real_distribution<float> any(-4.0f, 4.0f);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  auto randomVector = [&]() { return Vector4f(any(random), any(random), any(random), any(random)); };
+  auto randomQuaternion = [&]() {
+    Vector4f v = randomVector();
+    while (Dot(v, v) < 1e-3f) v = randomVector();
+    return ToQuaternion(Normalize(v));
+  };
+
+  for (int i = 0; i < BATCH; ++i) {
+    in.a[i] = randomVector();
+    in.b[i] = randomVector();
+    in.s[i] = any(random);
+    in.t[i] = unit(random);
+    for (int j = 0; j < 16; ++j) {
+      in.M[i](j / 4, j % 4) = any(random);
+      in.N[i](j / 4, j % 4) = any(random);
+      in.affine[i](j / 4, j % 4) = (j < 12) ? any(random) : ((j == 15) ? 1.0f : 0.0f);
+    }
+    for (int j = 0; j < 3; ++j) {
+      in.affine[i](j, j) += (in.affine[i](j, j) < 0.0f) ? -12.0f : 12.0f;
+    }
+    in.p[i] = randomQuaternion();
+    in.q[i] = randomQuaternion();
+    in.rigid[i] = RotationMatrix(in.p[i]);
+    in.rigid[i](0, 3) = any(random);
+    in.rigid[i](1, 3) = any(random);
+    in.rigid[i](2, 3) = any(random);
+
+    in.glmA[i] = toGlm(in.a[i]);
+    in.glmB[i] = toGlm(in.b[i]);
+    in.glmM[i] = toGlm(in.M[i]);
+    in.glmN[i] = toGlm(in.N[i]);
+    in.glmAffine[i] = toGlm(in.affine[i]);
+    in.glmRigid[i] = toGlm(in.rigid[i]);
+    in.glmP[i] = toGlm(in.p[i]);
+    in.glmQ[i] = toGlm(in.q[i]);
+  }
+}
+
+// Size of one ULP at the magnitude of x (the float spacing there)
+double ulpAt(float x) {
+  x = std::fabs(x);
+  if (x < std::numeric_limits<float>::min()) x = std::numeric_limits<float>::min();
+  return std::nextafter(x, std::numeric_limits<float>::infinity()) - x;
+}
+
+// Sum of the magnitudes of the terms added up into each component of
+// a result, e.g. |a.x b.x| + ... + |a.w b.w| for a dot product (scalar
+// results use the first entry). Zero for operations that are not a
+// plain sum of products.
+using TermScale = std::array<float, 4>;
+
+// Largest difference over n components, in ULPs of the largest
+// expected component, or of the component's term scale when that is
+// larger
+double ulpError(const float *ours, const float *expected, int n, const float *termScale) {
+  float largest = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    if (!std::isfinite(ours[i]) || !std::isfinite(expected[i])) {
+      return (std::isnan(ours[i]) && std::isnan(expected[i])) || ours[i] == expected[i] ?
+        0.0 : std::numeric_limits<double>::infinity();
+    }
+    largest = std::fmax(largest, std::fabs(expected[i]));
+  }
+  double error = 0.0;
+  for (int i = 0; i < n; ++i) {
+    const float scale = (termScale != nullptr) ? std::fmax(largest, termScale[i]) : largest;
+    error = std::fmax(error, std::fabs(static_cast<double>(ours[i]) - expected[i]) / ulpAt(scale));
+  }
+  return error;
+}
+
+double ulpError(float ours, float expected, const TermScale &terms) {
+  return ulpError(&ours, &expected, 1, terms.data());
+}
+
+double ulpError(const Vector4f &ours, const glm::vec4 &expected, const TermScale &terms) {
+  return ulpError(&ours.x, &expected.x, 4, terms.data());
+}
+
+// Cross products: only x, y, z are compared
+double ulpError(const Vector4f &ours, const glm::vec3 &expected, const TermScale &terms) {
+  return ulpError(&ours.x, &expected.x, 3, terms.data());
+}
+
+// Matrices and quaternions are judged by their largest entry only
+double ulpError(const Matrix4f &ours, const glm::mat4 &expected, const TermScale &) {
+  float values[16];
+  for (int j = 0; j < 16; ++j) values[j] = ours(j % 4, j / 4);
+  return ulpError(values, &expected[0][0], 16, nullptr);
+}
+
+// Normal matrices: the upper 3x3 against glm's mat3
+double ulpError(const Matrix4f &ours, const glm::mat3 &expected, const TermScale &) {
+  float values[9];
+  for (int j = 0; j < 9; ++j) values[j] = ours(j % 3, j / 3);
+  return ulpError(values, &expected[0][0], 9, nullptr);
+}
+
+// q and -q are the same rotation, so the sign is matched first
+double ulpError(const Quaternion &ours, const glm::quat &expected, const TermScale &) {
+  const float sign = (Dot(ToVector(ours), Vector4f(expected.x, expected.y, expected.z, expected.w)) < 0.0f) ? -1.0f : 1.0f;
+  const float values[4] = { ours.x * sign, ours.y * sign, ours.z * sign, ours.w * sign };
+  const float glmValues[4] = { expected.x, expected.y, expected.z, expected.w };
+  return ulpError(values, glmValues, 4, nullptr);
+}
+
+// Keeps results alive so the work is not optimized away
+volatile float sink;
+
+float firstValue(float f) { return f; }
+float firstValue(const Vector4f &v) { return v.x; }
+float firstValue(const Matrix4f &M) { return M(0, 0); }
+float firstValue(const Quaternion &q) { return q.x; }
+float firstValue(const glm::vec3 &v) { return v.x; }
+float firstValue(const glm::vec4 &v) { return v.x; }
+float firstValue(const glm::mat3 &M) { return M[0][0]; }
+float firstValue(const glm::mat4 &M) { return M[0][0]; }
+float firstValue(const glm::quat &q) { return q.x; }
+
+class Check {
+public:
+  Check(const char *name, double tolerance)
+    : name_(name), tolerance_(tolerance) {
+  }
+  virtual ~Check() = default;
+
+  // Runs and compares both sides on one batch of inputs
+  virtual void run(const Inputs &in) = 0;
+
+  std::string name_;
+  double tolerance_;
+  long samples_{ 0 };
+  double maxUlps_{ 0.0 };
+  double sumUlps_{ 0.0 };
+  double ns_{ 0.0 };
+  double glmNs_{ 0.0 };
+};
+
+template <typename Function>
+double timeNs(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+// ours(in, i) and theirs(in, i) compute the operation on element i,
+// and terms(in, i) gives its TermScale
+template <typename Ours, typename Theirs, typename Terms>
+class CheckOf : public Check {
+public:
+  CheckOf(const char *name, double tolerance, Ours ours, Theirs theirs, Terms terms)
+    : Check(name, tolerance), ours_(ours), theirs_(theirs), terms_(terms),
+      results_(BATCH), glmResults_(BATCH) {
+  }
+
+  void run(const Inputs &in) override {
+    ns_ += timeNs([&]() {
+      for (int i = 0; i < BATCH; ++i) results_[i] = ours_(in, i);
+    });
+    sink = firstValue(results_[BATCH / 2]);
+    glmNs_ += timeNs([&]() {
+      for (int i = 0; i < BATCH; ++i) glmResults_[i] = theirs_(in, i);
+    });
+    sink = firstValue(glmResults_[BATCH / 2]);
+
+    for (int i = 0; i < BATCH; ++i) {
+      double ulps = ulpError(results_[i], glmResults_[i], terms_(in, i));
+      maxUlps_ = std::fmax(maxUlps_, ulps);
+      sumUlps_ += ulps;
+    }
+    samples_ += BATCH;
+  }
+
+private:
+  using Result = decltype(std::declval<Ours>()(std::declval<const Inputs &>(), 0));
+  using GlmResult = decltype(std::declval<Theirs>()(std::declval<const Inputs &>(), 0));
+
+  Ours ours_;
+  Theirs theirs_;
+  Terms terms_;
+  std::vector<Result> results_;
+  std::vector<GlmResult> glmResults_;
+};
+
+template <typename Ours, typename Theirs, typename Terms>
+std::unique_ptr<Check> makeCheck(const char *name, double tolerance, Ours ours, Theirs theirs, Terms terms) {
+  return std::unique_ptr<Check>(new CheckOf<Ours, Theirs, Terms>(name, tolerance, ours, theirs, terms));
+}
+
+TermScale noTerms(const Inputs &, int) {
+  return TermScale();
+}
+
+template <typename Ours, typename Theirs>
+std::unique_ptr<Check> makeCheck(const char *name, double tolerance, Ours ours, Theirs theirs) {
+  return makeCheck(name, tolerance, ours, theirs, noTerms);
+}
+
+TermScale dotTerms(const Inputs &in, int i) {
+  const Vector4f &a = in.a[i], &b = in.b[i];
+  const float sum = std::fabs(a.x * b.x) + std::fabs(a.y * b.y) + std::fabs(a.z * b.z) + std::fabs(a.w * b.w);
+  return TermScale{ { sum, sum, sum, sum } };
+}
+
+TermScale crossTerms(const Inputs &in, int i) {
+  const Vector4f &a = in.a[i], &b = in.b[i];
+  return TermScale{ {
+    std::fabs(a.y * b.z) + std::fabs(a.z * b.y),
+    std::fabs(a.z * b.x) + std::fabs(a.x * b.z),
+    std::fabs(a.x * b.y) + std::fabs(a.y * b.x),
+    0.0f } };
+}
+
+TermScale matrixVectorTerms(const Inputs &in, int i) {
+  const float v[4] = { in.a[i].x, in.a[i].y, in.a[i].z, in.a[i].w };
+  TermScale terms{};
+  for (int row = 0; row < 4; ++row) {
+    for (int j = 0; j < 4; ++j) {
+      terms[row] += std::fabs(in.M[i](row, j) * v[j]);
+    }
+  }
+  return terms;
+}
+
+// Every term of the determinant is a product of one entry per row, so
+// the product of the rows' absolute sums bounds their magnitudes
+TermScale determinantTerms(const Inputs &in, int i) {
+  float bound = 1.0f;
+  for (int row = 0; row < 4; ++row) {
+    float sum = 0.0f;
+    for (int j = 0; j < 4; ++j) {
+      sum += std::fabs(in.affine[i](row, j));
+    }
+    bound *= sum;
+  }
+  return TermScale{ { bound, bound, bound, bound } };
+}
+
+// Tolerances are in ULPs of the largest component of the result, or
+// of the terms summed for the operations given a TermScale.
+// Operations written to add in glm's order should be exact; the rest
+// are allowed the rounding their formulas differ by.
+std::vector<std::unique_ptr<Check>> makeChecks() {
+  std::vector<std::unique_ptr<Check>> checks;
+  checks.push_back(makeCheck("Vector + Vector", 1,
+    [](const Inputs &in, int i) { return in.a[i] + in.b[i]; },
+    [](const Inputs &in, int i) { return in.glmA[i] + in.glmB[i]; }));
+  checks.push_back(makeCheck("Vector - Vector", 1,
+    [](const Inputs &in, int i) { return in.a[i] - in.b[i]; },
+    [](const Inputs &in, int i) { return in.glmA[i] - in.glmB[i]; }));
+  checks.push_back(makeCheck("Vector * Scalar", 1,
+    [](const Inputs &in, int i) { return in.a[i] * in.s[i]; },
+    [](const Inputs &in, int i) { return in.glmA[i] * in.s[i]; }));
+  checks.push_back(makeCheck("Vector / Scalar", 1,
+    [](const Inputs &in, int i) { return in.a[i] / in.s[i]; },
+    [](const Inputs &in, int i) { return in.glmA[i] / in.s[i]; }));
+  checks.push_back(makeCheck("Dot", 2,
+    [](const Inputs &in, int i) { return Dot(in.a[i], in.b[i]); },
+    [](const Inputs &in, int i) { return glm::dot(in.glmA[i], in.glmB[i]); }, dotTerms));
+  checks.push_back(makeCheck("Magnitude", 2,
+    [](const Inputs &in, int i) { return Magnitude(in.a[i]); },
+    [](const Inputs &in, int i) { return glm::length(in.glmA[i]); }));
+  checks.push_back(makeCheck("Normalize", 4,
+    [](const Inputs &in, int i) { return Normalize(in.a[i]); },
+    [](const Inputs &in, int i) { return glm::normalize(in.glmA[i]); }));
+  checks.push_back(makeCheck("CrossProduct", 4,
+    [](const Inputs &in, int i) { return CrossProduct(in.a[i], in.b[i]); },
+    [](const Inputs &in, int i) { return glm::cross(glm::vec3(in.glmA[i]), glm::vec3(in.glmB[i])); }, crossTerms));
+  checks.push_back(makeCheck("Matrix * Vector", 2,
+    [](const Inputs &in, int i) { return in.M[i] * in.a[i]; },
+    [](const Inputs &in, int i) { return in.glmM[i] * in.glmA[i]; }, matrixVectorTerms));
+  // Matrix4f's product lays A * B[j] out as rows, i.e. it is the
+  // transpose of glm's
+  checks.push_back(makeCheck("Matrix * Matrix", 4,
+    [](const Inputs &in, int i) { return in.M[i] * in.N[i]; },
+    [](const Inputs &in, int i) { return glm::transpose(in.glmM[i] * in.glmN[i]); }));
+  checks.push_back(makeCheck("Transpose", 0,
+    [](const Inputs &in, int i) { return Transpose(in.M[i]); },
+    [](const Inputs &in, int i) { return glm::transpose(in.glmM[i]); }));
+  checks.push_back(makeCheck("Determinant", 16,
+    [](const Inputs &in, int i) { return Determinant(in.affine[i]); },
+    [](const Inputs &in, int i) { return glm::determinant(in.glmAffine[i]); }, determinantTerms));
+  checks.push_back(makeCheck("Inverse", 16,
+    [](const Inputs &in, int i) { return Inverse(in.affine[i]); },
+    [](const Inputs &in, int i) { return glm::inverse(in.glmAffine[i]); }));
+  checks.push_back(makeCheck("AffineInverse", 16,
+    [](const Inputs &in, int i) { return AffineInverse(in.affine[i]); },
+    [](const Inputs &in, int i) { return glm::inverse(in.glmAffine[i]); }));
+  // glm::inverse is the general cofactor inverse, whose rounding in
+  // the translation is what most of this measures
+  checks.push_back(makeCheck("RigidInverse", 32,
+    [](const Inputs &in, int i) { return RigidInverse(in.rigid[i]); },
+    [](const Inputs &in, int i) { return glm::inverse(in.glmRigid[i]); }));
+  checks.push_back(makeCheck("NormalMatrix", 16,
+    [](const Inputs &in, int i) { return NormalMatrix(in.affine[i]); },
+    [](const Inputs &in, int i) { return glm::inverseTranspose(glm::mat3(in.glmAffine[i])); }));
+  checks.push_back(makeCheck("Quaternion * Quat", 4,
+    [](const Inputs &in, int i) { return in.p[i] * in.q[i]; },
+    [](const Inputs &in, int i) { return in.glmP[i] * in.glmQ[i]; }));
+  checks.push_back(makeCheck("Slerp", 16,
+    [](const Inputs &in, int i) { return Slerp(in.p[i], in.q[i], in.t[i]); },
+    [](const Inputs &in, int i) { return glm::slerp(in.glmP[i], in.glmQ[i], in.t[i]); }));
+  checks.push_back(makeCheck("RotationMatrix", 4,
+    [](const Inputs &in, int i) { return RotationMatrix(in.p[i]); },
+    [](const Inputs &in, int i) { return glm::mat4_cast(in.glmP[i]); }));
+  checks.push_back(makeCheck("MakeFromMatrix", 16,
+    [](const Inputs &in, int i) { return Quaternion::MakeFromMatrix(in.rigid[i]); },
+    [](const Inputs &in, int i) { return glm::quat_cast(in.glmRigid[i]); }));
+  checks.push_back(makeCheck("Rotate", 8,
+    [](const Inputs &in, int i) { return Rotate(in.p[i], in.a[i]); },
+    [](const Inputs &in, int i) { return glm::vec4(in.glmP[i] * glm::vec3(in.glmA[i]), in.glmA[i].w); }));
+  return checks;
+}
+
+// Reads operation -> ns/op from an earlier --csv run
+std::map<std::string, double> readBaseline(const char *path) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line); // header
+  while (std::getline(file, line)) {
+    std::stringstream fields(line);
+    std::string name, samples, maxUlps, meanUlps, tolerance, ns;
+    if (std::getline(fields, name, ',') && std::getline(fields, samples, ',') &&
+      std::getline(fields, maxUlps, ',') && std::getline(fields, meanUlps, ',') &&
+      std::getline(fields, tolerance, ',') && std::getline(fields, ns, ',')) {
+      baseline[name] = std::atof(ns.c_str());
+    }
+  }
+  return baseline;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long samples = 1000000;
+  unsigned int seed = 1;
+  bool csv = false;
+  const char *baselinePath = nullptr;
+  double maxSlowdown = 1.5;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+      samples = std::atol(argv[++i]);
+    } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = static_cast<unsigned int>(std::atol(argv[++i]));
+    } else if (std::strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--max-slowdown") == 0 && i + 1 < argc) {
+      maxSlowdown = std::atof(argv[++i]);
+    } else {
+      std::fprintf(stderr,
+        "usage: %s [--samples N] [--seed S] [--csv] [--baseline results.csv] [--max-slowdown F]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  std::map<std::string, double> baseline;
+  if (baselinePath != nullptr) {
+    baseline = readBaseline(baselinePath);
+    if (baseline.empty()) {
+      std::fprintf(stderr, "could not read a baseline from %s\n", baselinePath);
+      return 2;
+    }
+  }
+
+  std::vector<std::unique_ptr<Check>> checks = makeChecks();
+  Inputs inputs;
+  std::mt19937 random(seed);
+  const long batches = std::max(1L, (samples + BATCH - 1) / BATCH);
+  for (long batch = 0; batch < batches; ++batch) {
+    generate(inputs, random);
+    for (auto &check : checks) {
+      check->run(inputs);
+    }
+  }
+
+  if (csv) {
+    std::printf("operation,samples,max_ulps,mean_ulps,tolerance_ulps,ns_per_op,glm_ns_per_op,result\n");
+  } else {
+#ifdef MATH_SSE
+    std::printf("Vector4f/Matrix4f with SSE, seed %u\n", seed);
+#else
+    std::printf("Vector4f/Matrix4f scalar (MATH_NO_SIMD), seed %u\n", seed);
+#endif
+    std::printf("%-20s %10s %9s %9s %7s %9s %9s  %s\n",
+      "operation", "samples", "max ulps", "mean ulps", "limit", "ns/op", "glm ns/op", "result");
+  }
+
+  bool passed = true;
+  for (const auto &check : checks) {
+    const double ns = check->ns_ / check->samples_;
+    const double glmNs = check->glmNs_ / check->samples_;
+    const char *result = "pass";
+    if (!(check->maxUlps_ <= check->tolerance_)) {
+      result = "inaccurate";
+    } else if (baselinePath != nullptr) {
+      auto previous = baseline.find(check->name_);
+      if (previous != baseline.end() && ns > previous->second * maxSlowdown) result = "slower";
+    }
+    passed = passed && std::strcmp(result, "pass") == 0;
+
+    const double meanUlps = check->sumUlps_ / check->samples_;
+    if (csv) {
+      std::printf("%s,%ld,%.3f,%.4f,%.0f,%.3f,%.3f,%s\n", check->name_.c_str(), check->samples_,
+        check->maxUlps_, meanUlps, check->tolerance_, ns, glmNs, result);
+    } else {
+      std::printf("%-20s %10ld %9.2f %9.4f %7.0f %9.2f %9.2f  %s\n", check->name_.c_str(), check->samples_,
+        check->maxUlps_, meanUlps, check->tolerance_, ns, glmNs, result);
+    }
+  }
+  return passed ? 0 : 1;
+}
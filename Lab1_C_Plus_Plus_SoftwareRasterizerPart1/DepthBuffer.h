@@ -0,0 +1,119 @@
+#ifndef DEPTHBUFFER_H
+#define DEPTHBUFFER_H
+/** @file DepthBuffer.h
+ *  @brief Class for a float depth buffer
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  Stores one depth per pixel, 0 at the near plane and 1 at the far
+ *  plane. A pixel is only drawn when it is nearer than what the
+ *  buffer holds.
+ *
+ *  The buffer also keeps, for each 8x8 block of pixels, a depth no
+ *  nearer than the farthest pixel in that block. A triangle whose
+ *  nearest point over a block is farther than that depth is hidden
+ *  in the whole block, so the rasterizer can skip the block without
+ *  testing its pixels one by one ("early-z").
+ *
+ *  Small triangles rarely cover a whole block, so each block also
+ *  gathers the pixels triangles have covered so far and the farthest
+ *  depth left at them. Once those pixels fill the block, that depth
+ *  becomes the block's farthest and gathering starts again.
+ *
+ *  @bug No known bugs.
+ */
+
+// Standard Libraries
+#include <algorithm>
+#include <vector>
+
+class DepthBuffer{
+public:
+
+    // Size of the square blocks the early-z test works on
+    enum { BLOCK_SIZE = 8 };
+
+    // Constructor
+    // A buffer with every pixel at the far plane.
+    DepthBuffer(unsigned int _width, unsigned int _height){
+        width = _width;
+        height = _height;
+        blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        earlyZ = true;
+        depth.resize(width * height);
+        blockFarthest.resize(blocksX * blocksY);
+        gatheredMask.resize(blocksX * blocksY);
+        gatheredFarthest.resize(blocksX * blocksY);
+        clear();
+    }
+
+    // Sets every pixel back to the far plane
+    void clear(){
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        std::fill(blockFarthest.begin(), blockFarthest.end(), 1.0f);
+        std::fill(gatheredMask.begin(), gatheredMask.end(), 0ULL);
+        std::fill(gatheredFarthest.begin(), gatheredFarthest.end(), 0.0f);
+    }
+
+    unsigned int getWidth() const { return width; }
+    unsigned int getHeight() const { return height; }
+
+    // Row-major depths, like the pixels of a TGA
+    float* getDepthData() { return &depth[0]; }
+
+    // Depth of pixel (x, y)
+    float getDepth(int x, int y) const { return depth[y * width + x]; }
+
+    // Whether rasterizers should use the per block test. Turning it
+    // off gives the same image, only slower.
+    bool getEarlyZ() const { return earlyZ; }
+    void setEarlyZ(bool enabled){ earlyZ = enabled; }
+
+    // True when nothing nearer than nearest can be visible anywhere in
+    // the block holding pixel (x, y)
+    bool blockHidden(int x, int y, float nearest) const{
+        return nearest >= blockFarthest[(y / BLOCK_SIZE) * blocksX + x / BLOCK_SIZE];
+    }
+
+    // Records that the pixels of the block holding pixel (x, y) set in
+    // mask (bit 8 * row + column, within the block) are now at
+    // farthest or nearer.
+    void coverBlock(int x, int y, unsigned long long mask, float farthest){
+        const int bx = x / BLOCK_SIZE, by = y / BLOCK_SIZE;
+        const int block = by * blocksX + bx;
+        gatheredMask[block] |= mask;
+        gatheredFarthest[block] = std::max(gatheredFarthest[block], farthest);
+        if(gatheredMask[block] == blockMask(bx, by)){
+            blockFarthest[block] = std::min(blockFarthest[block], gatheredFarthest[block]);
+            gatheredMask[block] = 0;
+            gatheredFarthest[block] = 0.0f;
+        }
+    }
+
+private:
+    // Bits of the pixels block (bx, by) has; fewer than 64 along the
+    // right and bottom edges of the buffer
+    unsigned long long blockMask(int bx, int by) const{
+        const int columns = std::min<int>(BLOCK_SIZE, width - bx * BLOCK_SIZE);
+        const int rows = std::min<int>(BLOCK_SIZE, height - by * BLOCK_SIZE);
+        const unsigned long long row = (1ULL << columns) - 1;
+        unsigned long long mask = 0;
+        for(int i = 0; i < rows; ++i){
+            mask |= row << (i * BLOCK_SIZE);
+        }
+        return mask;
+    }
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int blocksX;
+    unsigned int blocksY;
+    bool earlyZ;
+    std::vector<float> depth;
+    std::vector<float> blockFarthest;
+    std::vector<unsigned long long> gatheredMask;
+    std::vector<float> gatheredFarthest;
+};
+
+#endif
@@ -1,12 +1,27 @@
+#ifndef GL_H
+#define GL_H
 /** @file GL.h
  *  @brief Our Great Looking Software Render functions
- *  
+ *
  *  Most of these functions have some correspondance
  *  with the OpenGL library.
  *
  *  @author Mike Shah
  *  @bug No known bugs.
  */
+
+// Standard Libraries
+#include <algorithm>
+#include <vector>
+
+// User Libraries
+#include "Color.h"
+#include "Lines.h"
+#include "Maths.h"
+#include "Rasterizer.h"
+#include "TGA.h"
+#include "TiledRasterizer.h"
+
 // Graphic Pipeline States
 // Globals that define how to draw our shapes.
 const int LINE = 0;
@@ -17,3 +32,148 @@ int glFillMode = LINE;
 void glPolygonMode(const int mode){
     glFillMode = mode;
 }
+
+// Records draw calls to run later as one batch, the way GL drivers
+// queue commands instead of drawing on every call.
+//
+// polygonMode() and triangle() only record. flush() then:
+//  - culls triangles that cannot draw anything: off the image, or
+//    of zero area in FILL mode (in LINE mode their edges still show),
+//  - splits what is left into batches of consecutive triangles with
+//    the same polygon mode, so state is looked at once per batch,
+//  - draws each batch in one pass, FILL batches on threadCount
+//    threads through TiledRasterizer.
+//
+// Batches run in the order recorded and triangles keep their order
+// within a batch, so the image is the same as drawing every call
+// at once. Moving triangles across a mode change to make bigger
+// batches would change the image wherever they overlap.
+class GLCommandQueue{
+public:
+
+    // What the last flush() did
+    struct Stats{
+        std::size_t recorded;
+        std::size_t culledDegenerate;
+        std::size_t culledOffscreen;
+        std::size_t batches;
+    };
+
+    // Constructor
+    // Starts in LINE mode, like glFillMode.
+    GLCommandQueue(){
+        mode = LINE;
+        stats = Stats();
+        tiledWidth = tiledHeight = 0;
+    }
+
+    // Records a polygon mode change for the triangles that follow
+    void polygonMode(const int _mode){
+        mode = _mode;
+    }
+
+    // Records a triangle in the current polygon mode
+    void triangle(Vec2 v0, Vec2 v1, Vec2 v2, ColorRGB c){
+        Command command;
+        command.v[0] = v0;
+        command.v[1] = v1;
+        command.v[2] = v2;
+        command.color = c;
+        command.mode = mode;
+        commands.push_back(command);
+    }
+
+    // Draws everything recorded into image and empties the queue.
+    // The polygon mode carries over to the next commands.
+    void flush(TGA& image, unsigned int threadCount = 1){
+        stats = Stats();
+        stats.recorded = commands.size();
+        cull(image.getWidth(), image.getHeight());
+
+        std::size_t start = 0;
+        while(start < commands.size()){
+            std::size_t end = start + 1;
+            while(end < commands.size() && commands[end].mode == commands[start].mode){
+                ++end;
+            }
+            if(commands[start].mode == FILL){
+                drawFilled(start, end, image, threadCount);
+            }
+            else{
+                drawOutlines(start, end, image);
+            }
+            ++stats.batches;
+            start = end;
+        }
+        commands.clear();
+    }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Command{
+        Vec2 v[3];
+        ColorRGB color;
+        int mode;
+    };
+
+    // Drops the commands that would draw nothing, keeping the order
+    void cull(int width, int height){
+        std::size_t kept = 0;
+        for(std::size_t i = 0; i < commands.size(); ++i){
+            const Command& c = commands[i];
+            const int minX = std::min(c.v[0].x, std::min(c.v[1].x, c.v[2].x));
+            const int minY = std::min(c.v[0].y, std::min(c.v[1].y, c.v[2].y));
+            const int maxX = std::max(c.v[0].x, std::max(c.v[1].x, c.v[2].x));
+            const int maxY = std::max(c.v[0].y, std::max(c.v[1].y, c.v[2].y));
+            if(maxX < 0 || maxY < 0 || minX >= width || minY >= height){
+                ++stats.culledOffscreen;
+            }
+            else if(c.mode == FILL && edgeFunction(c.v[0], c.v[1], c.v[2]) == 0){
+                ++stats.culledDegenerate;
+            }
+            else{
+                commands[kept++] = c;
+            }
+        }
+        commands.resize(kept);
+    }
+
+    void drawFilled(std::size_t start, std::size_t end, TGA& image, unsigned int threadCount){
+        if(threadCount <= 1){
+            for(std::size_t i = start; i < end; ++i){
+                fillTriangle(commands[i].v[0], commands[i].v[1], commands[i].v[2], image, commands[i].color);
+            }
+            return;
+        }
+        // The bins keep their memory from one flush to the next
+        if(tiled.empty() || tiledWidth != image.getWidth() || tiledHeight != image.getHeight()){
+            tiled.assign(1, TiledRasterizer(image.getWidth(), image.getHeight()));
+            tiledWidth = image.getWidth();
+            tiledHeight = image.getHeight();
+        }
+        tiled[0].clear();
+        for(std::size_t i = start; i < end; ++i){
+            tiled[0].addTriangle(commands[i].v[0], commands[i].v[1], commands[i].v[2], commands[i].color);
+        }
+        tiled[0].render(image, threadCount);
+    }
+
+    void drawOutlines(std::size_t start, std::size_t end, TGA& image){
+        for(std::size_t i = start; i < end; ++i){
+            const Vec2* v = commands[i].v;
+            const Vec2 edges[6] = { v[0], v[1], v[1], v[2], v[2], v[0] };
+            drawLines(edges, 6, image, commands[i].color);
+        }
+    }
+
+    int mode;
+    Stats stats;
+    std::vector<Command> commands;
+    // Zero or one TiledRasterizer, made the first time it is needed
+    std::vector<TiledRasterizer> tiled;
+    unsigned int tiledWidth;
+    unsigned int tiledHeight;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef LINES_H
+#define LINES_H
+/** @file Lines.h
+ *  @brief Drawing clipped lines with integer math only
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  Lines use Bresenham's algorithm. Along the line's longer axis
+ *  (its "major" axis) every pixel is drawn. The pixel k steps from
+ *  the start is moved
+ *
+ *      q(k) = floor((2 * k * d + D) / (2 * D))
+ *
+ *  pixels along the other axis, where D and d are the line's lengths
+ *  along the major and minor axes. That is k * d / D rounded to the
+ *  nearest pixel. Bresenham keeps the remainder of that division and
+ *  updates it with one addition per pixel, so there are no floats.
+ *
+ *  Lines are clipped to the image. The Cohen-Sutherland outcodes of
+ *  the endpoints accept lines entirely inside the image and reject
+ *  those entirely to one side of it. Any other line has its range of
+ *  k cut to the part inside the image, solving q(k) against the image
+ *  edges exactly. A clipped line therefore draws the same pixels
+ *  the whole line would have drawn on a bigger canvas.
+ *
+ *  @bug No known bugs.
+ */
+
+// Standard Libraries
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+
+// User Libraries
+#include "Color.h"
+#include "Maths.h"
+#include "TGA.h"
+
+// Cohen-Sutherland outcode bits: which sides of the image a point is past
+const int OUT_LEFT = 1;
+const int OUT_RIGHT = 2;
+const int OUT_TOP = 4;
+const int OUT_BOTTOM = 8;
+
+inline int outcode(const Vec2& p, int width, int height){
+    int code = 0;
+    if(p.x < 0){
+        code |= OUT_LEFT;
+    }
+    else if(p.x >= width){
+        code |= OUT_RIGHT;
+    }
+    if(p.y < 0){
+        code |= OUT_TOP;
+    }
+    else if(p.y >= height){
+        code |= OUT_BOTTOM;
+    }
+    return code;
+}
+
+// Endpoints must be within this many pixels of the image, so the
+// clipping math fits in 64 bits. Lines reaching farther are dropped.
+const int LINE_COORDINATE_LIMIT = 1 << 29;
+
+// Draws the line from v0 to v1, both ends included, in color c.
+// Only the part inside the image is drawn.
+inline void drawLine(Vec2 v0, Vec2 v1, TGA& image, ColorRGB c){
+    const int width = image.getWidth();
+    const int height = image.getHeight();
+    const int code0 = outcode(v0, width, height);
+    const int code1 = outcode(v1, width, height);
+    if(code0 & code1){
+        return; // Both ends past the same side
+    }
+    if(std::abs(v0.x) > LINE_COORDINATE_LIMIT || std::abs(v0.y) > LINE_COORDINATE_LIMIT ||
+       std::abs(v1.x) > LINE_COORDINATE_LIMIT || std::abs(v1.y) > LINE_COORDINATE_LIMIT){
+        return;
+    }
+
+    // Major axis: the one the line is longer along
+    const bool steep = std::abs(v1.y - v0.y) > std::abs(v1.x - v0.x);
+    const long long major0 = steep ? v0.y : v0.x;
+    const long long minor0 = steep ? v0.x : v0.y;
+    const long long D = std::abs(steep ? (long long)v1.y - v0.y : (long long)v1.x - v0.x);
+    const long long d = std::abs(steep ? (long long)v1.x - v0.x : (long long)v1.y - v0.y);
+    const int majorSign = (steep ? v1.y - v0.y : v1.x - v0.x) < 0 ? -1 : 1;
+    const int minorSign = (steep ? v1.x - v0.x : v1.y - v0.y) < 0 ? -1 : 1;
+
+    long long first = 0, last = D;
+    if(code0 | code1){
+        const long long majorSize = steep ? height : width;
+        const long long minorSize = steep ? width : height;
+
+        // major0 + majorSign * k within [0, majorSize)
+        if(majorSign > 0){
+            first = std::max(first, -major0);
+            last = std::min(last, majorSize - 1 - major0);
+        }
+        else{
+            first = std::max(first, major0 - (majorSize - 1));
+            last = std::min(last, major0);
+        }
+
+        // minor0 + minorSign * q(k) within [0, minorSize), as a range of q
+        const long long qLow = minorSign > 0 ? -minor0 : minor0 - (minorSize - 1);
+        const long long qHigh = minorSign > 0 ? minorSize - 1 - minor0 : minor0;
+        if(d == 0){
+            if(qLow > 0 || qHigh < 0){
+                return;
+            }
+        }
+        else{
+            // q(k) >= qLow  <=>  2kd + D >= 2D qLow
+            // q(k) <= qHigh <=>  2kd + D <  2D (qHigh + 1)
+            first = std::max(first, -floorDivide(D - 2 * D * qLow, 2 * d));
+            last = std::min(last, floorDivide(2 * D * (qHigh + 1) - D - 1, 2 * d));
+        }
+        if(first > last){
+            return;
+        }
+    }
+
+    // q and the remainder of the division at the first pixel
+    const long long numerator = 2 * first * d + D;
+    const long long q = D == 0 ? 0 : numerator / (2 * D);
+    long long remainder = numerator - q * 2 * D;
+
+    // Walk the buffer directly: one step along the major axis per
+    // pixel, and one along the minor axis when the remainder wraps
+    const std::ptrdiff_t pitch = (std::ptrdiff_t)width * 3;
+    const std::ptrdiff_t majorStep = majorSign * (steep ? pitch : 3);
+    const std::ptrdiff_t minorStep = minorSign * (steep ? 3 : pitch);
+    const long long x = steep ? minor0 + minorSign * q : major0 + majorSign * first;
+    const long long y = steep ? major0 + majorSign * first : minor0 + minorSign * q;
+    unsigned char* const pixels = image.getPixelData();
+    std::ptrdiff_t offset = y * pitch + x * 3;
+    for(long long k = first; k <= last; ++k){
+        pixels[offset] = c.r;
+        pixels[offset + 1] = c.g;
+        pixels[offset + 2] = c.b;
+        offset += majorStep;
+        remainder += 2 * d;
+        if(remainder >= 2 * D){
+            remainder -= 2 * D;
+            offset += minorStep;
+        }
+    }
+}
+
+// Draws the lines between points 0 and 1, 2 and 3, and so on
+// (count points, like GL_LINES) in color c.
+inline void drawLines(const Vec2* points, std::size_t count, TGA& image, ColorRGB c){
+    for(std::size_t i = 0; i + 1 < count; i += 2){
+        drawLine(points[i], points[i + 1], image, c);
+    }
+}
+
+#endif
@@ -12,6 +12,7 @@
  *  @bug No known bugs.
  */
 
+#include <cmath>
 
 // Structure for plotting integer points.
 struct Vec2{
@@ -49,7 +50,50 @@ struct Vec2{
     }
 };
 
+// Structure for 3D points and directions.
+struct Vec3f{
+    float x,y,z;
+    // Default Constructor
+    Vec3f(){
+        x = y = z = 0;
+    }
+    // Constructor with three arguments.
+    Vec3f(float _x, float _y, float _z): x{_x},y{_y},z{_z} {
+    }
+    // Add operator
+    Vec3f operator+(const Vec3f& a) const{
+        return Vec3f(x + a.x, y + a.y, z + a.z);
+    }
+    // Subtract operator
+    Vec3f operator-(const Vec3f& a) const{
+        return Vec3f(x - a.x, y - a.y, z - a.z);
+    }
+    // Scalar Multiplication
+    Vec3f operator*(const float& a) const{
+        return Vec3f(x * a, y * a, z * a);
+    }
+};
+
+// Floor of a / b for b > 0, rounding down for negative a too
+inline long long floorDivide(long long a, long long b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Dot product of two vectors
+inline float dot(const Vec3f& a, const Vec3f& b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Cross product of two vectors
+inline Vec3f cross(const Vec3f& a, const Vec3f& b){
+    return Vec3f(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
 
+// Vector of length one in the direction of a
+inline Vec3f normalize(const Vec3f& a){
+    float length = std::sqrt(dot(a, a));
+    return length > 0 ? a * (1.0f / length) : a;
+}
 
 
 #endif
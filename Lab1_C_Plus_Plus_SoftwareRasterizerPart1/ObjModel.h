@@ -0,0 +1,155 @@
+#ifndef OBJMODEL_H
+#define OBJMODEL_H
+/** @file ObjModel.h
+ *  @brief Class for loading .obj models
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  Reads the positions (v), texture coordinates (vt), normals (vn)
+ *  and faces (f) of a Wavefront .obj file, which is all the
+ *  renderer needs. Faces may use any of the v, v/vt, v//vn and
+ *  v/vt/vn forms, and may have more than three corners; they are
+ *  split into triangles as a fan. Faces without a position for
+ *  every corner, or naming a vertex, texture coordinate or normal
+ *  the file does not have, are skipped. Materials, groups and the
+ *  like are ignored.
+ *
+ *  @bug No known bugs.
+ */
+
+// Standard Libraries
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// User Libraries
+#include "Maths.h"
+
+class ObjModel{
+public:
+
+    // One corner of a triangle: indices into the position, texture
+    // coordinate and normal lists, or -1 when the face gave none.
+    struct Corner{
+        int position;
+        int texCoord;
+        int normal;
+    };
+
+    // Loads fileName, replacing anything loaded before.
+    // Returns false if the file could not be opened.
+    bool load(const std::string& fileName){
+        std::ifstream file(fileName.c_str());
+        if(!file.is_open()){
+            return false;
+        }
+        positions.clear();
+        texCoords.clear();
+        normals.clear();
+        corners.clear();
+
+        std::string line;
+        while(std::getline(file, line)){
+            std::istringstream stream(line);
+            std::string type;
+            stream >> type;
+            if(type == "v"){
+                Vec3f p;
+                stream >> p.x >> p.y >> p.z;
+                positions.push_back(p);
+            }
+            else if(type == "vt"){
+                Vec3f t;
+                stream >> t.x >> t.y;
+                texCoords.push_back(t);
+            }
+            else if(type == "vn"){
+                Vec3f n;
+                stream >> n.x >> n.y >> n.z;
+                normals.push_back(n);
+            }
+            else if(type == "f"){
+                std::vector<Corner> face;
+                std::string token;
+                while(stream >> token){
+                    Corner corner;
+                    if(!parseCorner(token, corner)){
+                        face.clear();
+                        break;
+                    }
+                    face.push_back(corner);
+                }
+                // Fan: (0, 1, 2), (0, 2, 3), ...
+                for(std::size_t i = 2; i < face.size(); ++i){
+                    corners.push_back(face[0]);
+                    corners.push_back(face[i - 1]);
+                    corners.push_back(face[i]);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Positions, and texture coordinates (in x and y) and normals
+    // when the file has them
+    const std::vector<Vec3f>& getPositions() const { return positions; }
+    const std::vector<Vec3f>& getTexCoords() const { return texCoords; }
+    const std::vector<Vec3f>& getNormals() const { return normals; }
+
+    // Three corners per triangle
+    const std::vector<Corner>& getCorners() const { return corners; }
+    std::size_t getTriangleCount() const { return corners.size() / 3; }
+
+private:
+    // Parses "v", "v/vt", "v//vn" or "v/vt/vn". obj indices count
+    // from 1, or back from the end of the list when negative.
+    // Returns false if the position is missing, or any index is
+    // outside the lists read so far.
+    bool parseCorner(const std::string& token, Corner& corner) const{
+        int index[3] = { 0, 0, 0 };
+        int part = 0;
+        std::size_t start = 0;
+        while(part < 3){
+            std::size_t end = token.find('/', start);
+            std::string text = token.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if(!text.empty()){
+                index[part] = std::atoi(text.c_str());
+            }
+            ++part;
+            if(end == std::string::npos){
+                break;
+            }
+            start = end + 1;
+        }
+        corner.position = resolve(index[0], positions.size());
+        corner.texCoord = resolve(index[1], texCoords.size());
+        corner.normal = resolve(index[2], normals.size());
+        return index[0] != 0 &&
+               inRange(corner.position, positions.size()) &&
+               (index[1] == 0 || inRange(corner.texCoord, texCoords.size())) &&
+               (index[2] == 0 || inRange(corner.normal, normals.size()));
+    }
+
+    static int resolve(int index, std::size_t count){
+        if(index > 0){
+            return index - 1;
+        }
+        if(index < 0){
+            return (int)count + index;
+        }
+        return -1;
+    }
+
+    static bool inRange(int index, std::size_t count){
+        return index >= 0 && (std::size_t)index < count;
+    }
+
+    std::vector<Vec3f> positions;
+    std::vector<Vec3f> texCoords;
+    std::vector<Vec3f> normals;
+    std::vector<Corner> corners;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+/** @file Rasterizer.h
+ *  @brief Filling triangles with integer edge functions
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  Each edge a->b of a triangle splits the canvas in two. Its edge
+ *  function
+ *
+ *      E(p) = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x)
+ *
+ *  is positive on the inside, so a pixel is covered when all three
+ *  edge functions are. Moving one pixel right changes E by
+ *  -(b.y - a.y), and moving one row down changes it by (b.x - a.x).
+ *  After the first pixel, each test is three integer additions, with
+ *  no determinants or divisions per pixel.
+ *
+ *  A pixel exactly on an edge belongs to the triangle only if that
+ *  edge is a top or left edge (the "top-left rule" GPUs use). Two
+ *  triangles sharing an edge then never both draw it, and leave no
+ *  gap between them.
+ *
+ *  The bounding box is walked in 8x8 pixel blocks. E is linear, so
+ *  its smallest and largest values over a block are at the block's
+ *  corners. A block entirely outside one edge is skipped, and a
+ *  block inside all three edges is filled without any tests. Only
+ *  blocks crossing an edge are tested pixel by pixel, 8 pixels of a
+ *  row at once with SSE2 (or AVX2 when compiled with -mavx2), and
+ *  written with a masked store.
+ *
+ *  Define RASTERIZER_NO_SIMD before including this file to use plain
+ *  C++ only.
+ *
+ *  @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(RASTERIZER_NO_SIMD) && defined(__SSE2__)
+#define RASTERIZER_SSE
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define RASTERIZER_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#include "Color.h"
+#include "Maths.h"
+#include "TGA.h"
+
+// Edge function of the edge a->b at point p: twice the signed area
+// of the triangle a, b, p. 64-bit, so vertices far off the canvas
+// cannot overflow it.
+inline long long edgeFunction(const Vec2& a, const Vec2& b, const Vec2& p){
+    return (long long)(b.x - a.x) * (p.y - a.y) - (long long)(b.y - a.y) * (p.x - a.x);
+}
+
+// True for the edges that own the pixels lying exactly on them, with
+// the triangle's inside on the positive side of a->b. y grows
+// downwards, so a top edge is horizontal and runs right, and a left
+// edge runs up.
+inline bool isTopLeft(const Vec2& a, const Vec2& b){
+    return (b.y < a.y) || (b.y == a.y && b.x > a.x);
+}
+
+// Coverage of a block of 8 pixel wide rows. w holds the three edge
+// values at the block's top-left pixel, stepX and stepY their change
+// per pixel and per row. For each row y < rows, bit i of masks[y] is
+// set when pixel i of the row is inside all three edges (w >= 0).
+inline void blockCoverage(const int w[3], const int stepX[3], const int stepY[3],
+                          int rows, unsigned int masks[8]){
+#if defined(RASTERIZER_AVX2)
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(w[0]), _mm256_mullo_epi32(_mm256_set1_epi32(stepX[0]), lanes));
+    __m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(w[1]), _mm256_mullo_epi32(_mm256_set1_epi32(stepX[1]), lanes));
+    __m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(w[2]), _mm256_mullo_epi32(_mm256_set1_epi32(stepX[2]), lanes));
+    const __m256i down0 = _mm256_set1_epi32(stepY[0]);
+    const __m256i down1 = _mm256_set1_epi32(stepY[1]);
+    const __m256i down2 = _mm256_set1_epi32(stepY[2]);
+    for(int y = 0; y < rows; ++y){
+        // A pixel is outside when any of its edge values has the sign bit set
+        __m256i outside = _mm256_or_si256(_mm256_or_si256(e0, e1), e2);
+        masks[y] = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        e0 = _mm256_add_epi32(e0, down0);
+        e1 = _mm256_add_epi32(e1, down1);
+        e2 = _mm256_add_epi32(e2, down2);
+    }
+#elif defined(RASTERIZER_SSE)
+    // Pixels 0..3 of a row in lo, 4..7 in hi
+    __m128i lo0 = _mm_add_epi32(_mm_set1_epi32(w[0]), _mm_setr_epi32(0, stepX[0], 2 * stepX[0], 3 * stepX[0]));
+    __m128i lo1 = _mm_add_epi32(_mm_set1_epi32(w[1]), _mm_setr_epi32(0, stepX[1], 2 * stepX[1], 3 * stepX[1]));
+    __m128i lo2 = _mm_add_epi32(_mm_set1_epi32(w[2]), _mm_setr_epi32(0, stepX[2], 2 * stepX[2], 3 * stepX[2]));
+    __m128i hi0 = _mm_add_epi32(lo0, _mm_set1_epi32(4 * stepX[0]));
+    __m128i hi1 = _mm_add_epi32(lo1, _mm_set1_epi32(4 * stepX[1]));
+    __m128i hi2 = _mm_add_epi32(lo2, _mm_set1_epi32(4 * stepX[2]));
+    const __m128i down0 = _mm_set1_epi32(stepY[0]);
+    const __m128i down1 = _mm_set1_epi32(stepY[1]);
+    const __m128i down2 = _mm_set1_epi32(stepY[2]);
+    for(int y = 0; y < rows; ++y){
+        // A pixel is outside when any of its edge values has the sign bit set
+        __m128i outsideLo = _mm_or_si128(_mm_or_si128(lo0, lo1), lo2);
+        __m128i outsideHi = _mm_or_si128(_mm_or_si128(hi0, hi1), hi2);
+        unsigned int outside = _mm_movemask_ps(_mm_castsi128_ps(outsideLo)) |
+                               (_mm_movemask_ps(_mm_castsi128_ps(outsideHi)) << 4);
+        masks[y] = ~outside & 0xFF;
+        lo0 = _mm_add_epi32(lo0, down0);
+        lo1 = _mm_add_epi32(lo1, down1);
+        lo2 = _mm_add_epi32(lo2, down2);
+        hi0 = _mm_add_epi32(hi0, down0);
+        hi1 = _mm_add_epi32(hi1, down1);
+        hi2 = _mm_add_epi32(hi2, down2);
+    }
+#else
+    int row0 = w[0], row1 = w[1], row2 = w[2];
+    for(int y = 0; y < rows; ++y){
+        int w0 = row0, w1 = row1, w2 = row2;
+        unsigned int mask = 0;
+        for(int i = 0; i < 8; ++i){
+            if((w0 | w1 | w2) >= 0){
+                mask |= 1u << i;
+            }
+            w0 += stepX[0];
+            w1 += stepX[1];
+            w2 += stepX[2];
+        }
+        masks[y] = mask;
+        row0 += stepY[0];
+        row1 += stepY[1];
+        row2 += stepY[2];
+    }
+#endif
+}
+
+#if defined(RASTERIZER_SSE)
+// For each 8 bit coverage mask, 24 bytes that are 0xFF for the
+// R,G,B bytes of the covered pixels
+struct CoverageByteMasks{
+    unsigned char bytes[256][32];
+    CoverageByteMasks(){
+        std::memset(bytes, 0, sizeof(bytes));
+        for(int mask = 0; mask < 256; ++mask){
+            for(int i = 0; i < 8; ++i){
+                if(mask & (1 << i)){
+                    std::memset(&bytes[mask][i * 3], 0xFF, 3);
+                }
+            }
+        }
+    }
+};
+
+inline const CoverageByteMasks& coverageByteMasks(){
+    static const CoverageByteMasks masks;
+    return masks;
+}
+#endif
+
+// Writes color c to the pixels of an 8 pixel span whose bit is set
+// in mask. pattern holds c repeated 8 times. Only a span of 8 whole
+// pixels (full) may be read and written back as a block; otherwise
+// the pixels are written one at a time, so nothing past the span is
+// touched.
+inline void storeSpan(unsigned char* pixels, unsigned int mask, bool full,
+                      const unsigned char* pattern, ColorRGB c){
+    if(mask == 0){
+        return;
+    }
+    if(full && mask == 0xFF){
+        std::memcpy(pixels, pattern, 24);
+        return;
+    }
+#if defined(RASTERIZER_SSE)
+    if(full){
+        // Blend 16 + 8 bytes: new color where the mask is set
+        const unsigned char* bytes = coverageByteMasks().bytes[mask];
+        __m128i m = _mm_loadu_si128((const __m128i*)bytes);
+        __m128i p = _mm_loadu_si128((const __m128i*)pattern);
+        __m128i old = _mm_loadu_si128((const __m128i*)pixels);
+        _mm_storeu_si128((__m128i*)pixels, _mm_or_si128(_mm_and_si128(m, p), _mm_andnot_si128(m, old)));
+        m = _mm_loadl_epi64((const __m128i*)(bytes + 16));
+        p = _mm_loadl_epi64((const __m128i*)(pattern + 16));
+        old = _mm_loadl_epi64((const __m128i*)(pixels + 16));
+        _mm_storel_epi64((__m128i*)(pixels + 16), _mm_or_si128(_mm_and_si128(m, p), _mm_andnot_si128(m, old)));
+        return;
+    }
+#else
+    (void)full;
+    (void)pattern;
+#endif
+    for(int i = 0; mask != 0; ++i, mask >>= 1){
+        if(mask & 1){
+            pixels[i * 3] = c.r;
+            pixels[i * 3 + 1] = c.g;
+            pixels[i * 3 + 2] = c.b;
+        }
+    }
+}
+
+// Fills the part of the triangle v0, v1, v2 (in either winding) that
+// lies in the rectangle clipMinX..clipMaxX, clipMinY..clipMaxY
+// (inclusive, and inside the image) with color c. The pixels drawn
+// do not depend on the rectangle, so filling a triangle piece by
+// piece gives the same image as filling it whole. No pixel outside
+// the rectangle is read or written.
+inline void fillTriangle(Vec2 v0, Vec2 v1, Vec2 v2, TGA& image, ColorRGB c,
+                         int clipMinX, int clipMinY, int clipMaxX, int clipMaxY){
+    const long long area = edgeFunction(v0, v1, v2);
+    if(area == 0){
+        return; // Degenerate: no pixels
+    }
+    if(area < 0){
+        std::swap(v1, v2);
+    }
+
+    // Bounding box, clipped
+    const int minX = std::max(std::min(v0.x, std::min(v1.x, v2.x)), clipMinX);
+    const int minY = std::max(std::min(v0.y, std::min(v1.y, v2.y)), clipMinY);
+    const int maxX = std::min(std::max(v0.x, std::max(v1.x, v2.x)), clipMaxX);
+    const int maxY = std::min(std::max(v0.y, std::max(v1.y, v2.y)), clipMaxY);
+    if(minX > maxX || minY > maxY){
+        return;
+    }
+
+    // Edge functions at the top-left corner of the box. Edges that do
+    // not own their pixels start one lower, so "covered" is simply
+    // w >= 0 for all three.
+    const Vec2 corner(minX, minY);
+    long long w[3];
+    w[0] = edgeFunction(v1, v2, corner) - (isTopLeft(v1, v2) ? 0 : 1);
+    w[1] = edgeFunction(v2, v0, corner) - (isTopLeft(v2, v0) ? 0 : 1);
+    w[2] = edgeFunction(v0, v1, corner) - (isTopLeft(v0, v1) ? 0 : 1);
+
+    // Change per pixel to the right and per row down
+    const long long stepX[3] = { (long long)v1.y - v2.y, (long long)v2.y - v0.y, (long long)v0.y - v1.y };
+    const long long stepY[3] = { (long long)v2.x - v1.x, (long long)v0.x - v2.x, (long long)v1.x - v0.x };
+
+    const std::size_t pitch = (std::size_t)image.getWidth() * 3;
+    unsigned char* const boxPixels = image.getPixelData() + (std::size_t)minY * pitch + (std::size_t)minX * 3;
+
+    // Inside a block that crosses an edge, that edge's values are
+    // within 7 * (|stepX| + |stepY|) of zero. Keeping the steps
+    // below 2^26 lets the pixel tests use 32-bit integers. Larger
+    // triangles are filled one pixel at a time with 64-bit values,
+    // and so are triangles within a single block, for which setting
+    // up the block tests costs more than it saves.
+    const long long maxStep = 1LL << 26;
+    bool smallSteps = true;
+    for(int e = 0; e < 3; ++e){
+        smallSteps = smallSteps && std::abs(stepX[e]) < maxStep && std::abs(stepY[e]) < maxStep;
+    }
+    if(!smallSteps || (maxX - minX < 8 && maxY - minY < 8)){
+        unsigned char* rowPixels = boxPixels;
+        for(int y = minY; y <= maxY; ++y){
+            long long w0 = w[0], w1 = w[1], w2 = w[2];
+            unsigned char* pixel = rowPixels;
+            bool entered = false;
+            for(int x = minX; x <= maxX; ++x){
+                if((w0 | w1 | w2) >= 0){
+                    pixel[0] = c.r;
+                    pixel[1] = c.g;
+                    pixel[2] = c.b;
+                    entered = true;
+                }
+                else if(entered){
+                    break; // A triangle covers one run per row
+                }
+                w0 += stepX[0];
+                w1 += stepX[1];
+                w2 += stepX[2];
+                pixel += 3;
+            }
+            for(int e = 0; e < 3; ++e){
+                w[e] += stepY[e];
+            }
+            rowPixels += pitch;
+        }
+        return;
+    }
+
+    // The color repeated over a whole span
+    unsigned char pattern[32];
+    for(int i = 0; i < 8; ++i){
+        pattern[i * 3] = c.r;
+        pattern[i * 3 + 1] = c.g;
+        pattern[i * 3 + 2] = c.b;
+    }
+
+    for(int by = minY; by <= maxY; by += 8){
+        const int rows = std::min(8, maxY - by + 1);
+        long long blockW[3] = { w[0], w[1], w[2] };
+        for(int bx = minX; bx <= maxX; bx += 8){
+            const int cols = std::min(8, maxX - bx + 1);
+            unsigned char* const blockPixels = boxPixels + (std::size_t)(by - minY) * pitch + (std::size_t)(bx - minX) * 3;
+
+            // Smallest and largest value of each edge over the block
+            bool outside = false;
+            bool inside = true;
+            long long blockMin[3];
+            for(int e = 0; e < 3; ++e){
+                const long long dx = stepX[e] * (cols - 1);
+                const long long dy = stepY[e] * (rows - 1);
+                blockMin[e] = blockW[e] + std::min(dx, 0LL) + std::min(dy, 0LL);
+                const long long blockMax = blockW[e] + std::max(dx, 0LL) + std::max(dy, 0LL);
+                outside = outside || blockMax < 0;
+                inside = inside && blockMin[e] >= 0;
+            }
+
+            if(outside){
+                // Trivial reject
+            }
+            else if(inside){
+                // Trivial accept: every pixel of the block
+                unsigned char* rowPixels = blockPixels;
+                for(int y = 0; y < rows; ++y){
+                    std::memcpy(rowPixels, pattern, cols * 3);
+                    rowPixels += pitch;
+                }
+            }
+            else{
+                // An edge this block is fully inside cannot reject any of
+                // its pixels; pin it at 0 so the rest fit in 32 bits.
+                int blockW32[3], sx[3], sy[3];
+                for(int e = 0; e < 3; ++e){
+                    const bool passes = blockMin[e] >= 0;
+                    blockW32[e] = passes ? 0 : (int)blockW[e];
+                    sx[e] = passes ? 0 : (int)stepX[e];
+                    sy[e] = passes ? 0 : (int)stepY[e];
+                }
+                unsigned int masks[8];
+                blockCoverage(blockW32, sx, sy, rows, masks);
+                const unsigned int colMask = (1u << cols) - 1;
+                unsigned char* rowPixels = blockPixels;
+                for(int y = 0; y < rows; ++y){
+                    storeSpan(rowPixels, masks[y] & colMask, cols == 8, pattern, c);
+                    rowPixels += pitch;
+                }
+            }
+
+            for(int e = 0; e < 3; ++e){
+                blockW[e] += stepX[e] * 8;
+            }
+        }
+        for(int e = 0; e < 3; ++e){
+            w[e] += stepY[e] * 8;
+        }
+    }
+}
+
+// Fills the triangle v0, v1, v2 (in either winding) with color c.
+// Only the part inside the image is drawn.
+inline void fillTriangle(Vec2 v0, Vec2 v1, Vec2 v2, TGA& image, ColorRGB c){
+    fillTriangle(v0, v1, v2, image, c, 0, 0, (int)image.getWidth() - 1, (int)image.getHeight() - 1);
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef RASTERIZER3D_H
+#define RASTERIZER3D_H
+/** @file Rasterizer3D.h
+ *  @brief Filling 3D triangles with depth testing and interpolation
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  Triangles arrive already projected to the screen (see toScreen).
+ *  Coverage uses the same integer edge functions and top-left rule as
+ *  Rasterizer.h, but on positions with 4 bits below the pixel
+ *  (1/16th of a pixel), tested at the pixel centers.
+ *
+ *  The edge functions also give each pixel's barycentric weights.
+ *  Depth is interpolated with them directly, since z/w is linear on
+ *  the screen. Other attributes (colors, texture coordinates,
+ *  normals...) are not: they are interpolated as a/w and 1/w, and
+ *  divided per pixel, so they do not slide across the triangle in
+ *  perspective.
+ *
+ *  The bounding box is walked in the 8x8 blocks of the DepthBuffer.
+ *  A block outside an edge is skipped, and so is a block where the
+ *  triangle's nearest point is behind everything already drawn
+ *  there. Only pixels that pass the depth test are shaded.
+ *
+ *  @bug Triangles with a vertex behind the camera are not clipped;
+ *       callers drop them (see toScreen).
+ */
+
+// Standard Libraries
+#include <algorithm>
+#include <cmath>
+
+// User Libraries
+#include "Color.h"
+#include "DepthBuffer.h"
+#include "Maths.h"
+#include "TGA.h"
+
+// Most attributes a vertex can carry
+const int MAX_ATTRIBUTES = 8;
+
+// A vertex on the screen: x and y in pixels (y down), z from 0 (near)
+// to 1 (far), and 1/w of its clip position, for perspective correction.
+struct ScreenVertex{
+    float x, y, z;
+    float invW;
+    float attributes[MAX_ATTRIBUTES];
+};
+
+// Counts of the work done while drawing, for measuring overdraw
+// and what the depth test saves.
+struct RasterStats{
+    long long triangles;       // Triangles given to fillTriangle3D
+    long long blocksTested;    // 8x8 blocks touching a triangle
+    long long blocksHidden;    // Blocks skipped by early-z
+    long long pixelsCovered;   // Pixels inside a triangle that were depth tested
+    long long pixelsHidden;    // Of those, behind what was already drawn
+    long long pixelsShaded;    // Of those, shaded and written
+
+    RasterStats(){
+        triangles = blocksTested = blocksHidden = 0;
+        pixelsCovered = pixelsHidden = pixelsShaded = 0;
+    }
+};
+
+// Projects a clip space position (x, y, z, w), as produced by a
+// perspective matrix, onto a width x height image. Returns false when
+// the vertex is not in front of the camera (w <= 0), or so far
+// outside the image that the 1/16 pixel positions could overflow.
+inline bool toScreen(float clipX, float clipY, float clipZ, float clipW,
+                     const float* attributes, int attributeCount,
+                     int width, int height, ScreenVertex& out){
+    if(!(clipW > 0)){
+        return false;
+    }
+    const float invW = 1.0f / clipW;
+    out.x = (clipX * invW * 0.5f + 0.5f) * width;
+    out.y = (0.5f - clipY * invW * 0.5f) * height;
+    out.z = clipZ * invW * 0.5f + 0.5f;
+    out.invW = invW;
+    for(int i = 0; i < attributeCount; ++i){
+        out.attributes[i] = attributes[i];
+    }
+    const float limit = 1 << 20;
+    return std::fabs(out.x) < limit && std::fabs(out.y) < limit;
+}
+
+// Positions are fixed point with this many bits below the pixel
+const int SUBPIXEL_BITS = 4;
+const int SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+
+// Draws triangle v0, v1, v2 (in either winding). Each pixel covered
+// and nearer than depth holds gets shade(attributes), where attributes
+// are the first attributeCount vertex attributes interpolated to the
+// pixel center. shade is any function, lambda or functor taking
+// const float* and returning a ColorRGB.
+template <typename Shader>
+void fillTriangle3D(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                    int attributeCount, const Shader& shade,
+                    TGA& image, DepthBuffer& depth, RasterStats& stats){
+    ++stats.triangles;
+    const ScreenVertex* v[3] = { &v0, &v1, &v2 };
+
+    // Fixed point positions
+    long long px[3], py[3];
+    for(int i = 0; i < 3; ++i){
+        px[i] = (long long)std::floor(v[i]->x * SUBPIXEL_ONE + 0.5f);
+        py[i] = (long long)std::floor(v[i]->y * SUBPIXEL_ONE + 0.5f);
+    }
+    long long area = (px[1] - px[0]) * (py[2] - py[0]) - (py[1] - py[0]) * (px[2] - px[0]);
+    if(area == 0){
+        return;
+    }
+    if(area < 0){
+        std::swap(v[1], v[2]);
+        std::swap(px[1], px[2]);
+        std::swap(py[1], py[2]);
+        area = -area;
+    }
+
+    // Pixels whose centers lie in the bounding box, clipped
+    const long long half = SUBPIXEL_ONE / 2;
+    const int minX = (int)std::max(floorDivide(std::min(px[0], std::min(px[1], px[2])) - half + SUBPIXEL_ONE - 1, SUBPIXEL_ONE), 0LL);
+    const int minY = (int)std::max(floorDivide(std::min(py[0], std::min(py[1], py[2])) - half + SUBPIXEL_ONE - 1, SUBPIXEL_ONE), 0LL);
+    const int maxX = (int)std::min(floorDivide(std::max(px[0], std::max(px[1], px[2])) - half, SUBPIXEL_ONE), (long long)image.getWidth() - 1);
+    const int maxY = (int)std::min(floorDivide(std::max(py[0], std::max(py[1], py[2])) - half, SUBPIXEL_ONE), (long long)image.getHeight() - 1);
+    if(minX > maxX || minY > maxY){
+        return;
+    }
+
+    // Edge e runs between the two vertices other than e, so its value
+    // is the (scaled) barycentric weight of vertex e. As in
+    // Rasterizer.h, edges that do not own their pixels are biased
+    // by one so coverage is w >= 0 for all three.
+    long long ax[3], ay[3], stepX[3], stepY[3], bias[3];
+    for(int e = 0; e < 3; ++e){
+        const int a = (e + 1) % 3, b = (e + 2) % 3;
+        ax[e] = px[a];
+        ay[e] = py[a];
+        stepX[e] = -(py[b] - py[a]) * SUBPIXEL_ONE;
+        stepY[e] = (px[b] - px[a]) * SUBPIXEL_ONE;
+        const bool topLeft = (py[b] < py[a]) || (py[b] == py[a] && px[b] > px[a]);
+        bias[e] = topLeft ? 0 : 1;
+    }
+    // Value of edge e at the center of pixel (x, y), biased
+    auto edgeAt = [&](int e, int x, int y) -> long long {
+        const int b = (e + 2) % 3;
+        return (px[b] - ax[e]) * ((long long)y * SUBPIXEL_ONE + half - ay[e]) -
+               (py[b] - ay[e]) * ((long long)x * SUBPIXEL_ONE + half - ax[e]) - bias[e];
+    };
+
+    // Per vertex values that are interpolated linearly
+    const float invArea = 1.0f / (float)area;
+    const float z0 = v[0]->z, dz1 = v[1]->z - z0, dz2 = v[2]->z - z0;
+    const float triangleNearest = std::min(z0, std::min(v[1]->z, v[2]->z));
+
+    const int blockSize = DepthBuffer::BLOCK_SIZE;
+    const int width = image.getWidth();
+    const int height = image.getHeight();
+    unsigned char* const pixels = image.getPixelData();
+    float* const depths = depth.getDepthData();
+    float attributes[MAX_ATTRIBUTES];
+
+    for(int by = minY - minY % blockSize; by <= maxY; by += blockSize){
+        const int lastY = std::min(by + blockSize, height) - 1;
+        for(int bx = minX - minX % blockSize; bx <= maxX; bx += blockSize){
+            const int lastX = std::min(bx + blockSize, width) - 1;
+            ++stats.blocksTested;
+
+            // Edge values at the block's top-left pixel, and their range
+            long long w[3];
+            bool outside = false;
+            bool inside = true;
+            for(int e = 0; e < 3; ++e){
+                w[e] = edgeAt(e, bx, by);
+                const long long dx = stepX[e] * (lastX - bx);
+                const long long dy = stepY[e] * (lastY - by);
+                outside = outside || w[e] + std::max(dx, 0LL) + std::max(dy, 0LL) < 0;
+                inside = inside && w[e] + std::min(dx, 0LL) + std::min(dy, 0LL) >= 0;
+            }
+            if(outside){
+                continue;
+            }
+
+            if(depth.getEarlyZ()){
+                // z is a plane, so its nearest point over the block is
+                // at a corner. The small margin covers rounding, so
+                // early-z never hides a pixel the full test would draw.
+                float nearest = 1.0f;
+                const int cornerX[4] = { bx, lastX, bx, lastX };
+                const int cornerY[4] = { by, by, lastY, lastY };
+                for(int i = 0; i < 4; ++i){
+                    const float l1 = (edgeAt(1, cornerX[i], cornerY[i]) + bias[1]) * invArea;
+                    const float l2 = (edgeAt(2, cornerX[i], cornerY[i]) + bias[2]) * invArea;
+                    nearest = std::min(nearest, z0 + l1 * dz1 + l2 * dz2);
+                }
+                nearest = std::max(nearest, triangleNearest) - 1e-5f;
+                if(depth.blockHidden(bx, by, nearest)){
+                    ++stats.blocksHidden;
+                    continue;
+                }
+            }
+
+            // Pixels covered, and the farthest depth left at them
+            unsigned long long covered = 0;
+            float farthest = 0.0f;
+            for(int y = by; y <= lastY; ++y){
+                long long w0 = w[0], w1 = w[1], w2 = w[2];
+                for(int x = bx; x <= lastX; ++x){
+                    if(inside || (w0 | w1 | w2) >= 0){
+                        ++stats.pixelsCovered;
+                        const float l1 = (w1 + bias[1]) * invArea;
+                        const float l2 = (w2 + bias[2]) * invArea;
+                        const float z = z0 + l1 * dz1 + l2 * dz2;
+                        float& stored = depths[y * width + x];
+                        if(z < stored){
+                            stored = z;
+                            // Perspective correct weights
+                            const float p0 = (1.0f - l1 - l2) * v[0]->invW;
+                            const float p1 = l1 * v[1]->invW;
+                            const float p2 = l2 * v[2]->invW;
+                            const float normalize = 1.0f / (p0 + p1 + p2);
+                            for(int k = 0; k < attributeCount; ++k){
+                                attributes[k] = (p0 * v[0]->attributes[k] + p1 * v[1]->attributes[k] +
+                                                 p2 * v[2]->attributes[k]) * normalize;
+                            }
+                            const ColorRGB c = shade((const float*)attributes);
+                            unsigned char* pixel = pixels + (y * width + x) * 3;
+                            pixel[0] = c.r;
+                            pixel[1] = c.g;
+                            pixel[2] = c.b;
+                            ++stats.pixelsShaded;
+                        }
+                        else{
+                            ++stats.pixelsHidden;
+                        }
+                        covered |= 1ULL << ((y - by) * blockSize + (x - bx));
+                        farthest = std::max(farthest, stored);
+                    }
+                    w0 += stepX[0];
+                    w1 += stepX[1];
+                    w2 += stepX[2];
+                }
+                w[0] += stepY[0];
+                w[1] += stepY[1];
+                w[2] += stepY[2];
+            }
+            if(covered != 0){
+                depth.coverBlock(bx, by, covered, farthest);
+            }
+        }
+    }
+}
+
+#endif
@@ -15,6 +15,9 @@
  *
  *  TGA images also go by the name of TARGA.
  *
+ *  Images can be saved as .tga (plain or run length encoded) or
+ *  as binary .ppm. Each file is built in memory and written at once.
+ *
  *  @author Mike Shah
  *  @bug No known bugs.
  */
@@ -22,6 +25,8 @@
 // Standard Libraries
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <vector>
 
 // User Libraries
 #include "Color.h"
@@ -67,24 +72,108 @@ public:
         m_pixelData[((y*width+x)*3)+2] = c.b;
     }
 
-    // Helper function to write out a .tga image file
-    void outputTGAImage(std::string fileName){
-       std::ofstream myFile(fileName.c_str());
-       if(myFile.is_open()){
-            FILE *fp; fp = fopen(fileName.c_str(),"w+");
-            fputs("P3\n",fp); fputs("320 320\n",fp); fputs("255\n",fp);
-            for(int i =0; i < width*height*3;i++){
-                    fprintf(fp,"%d",m_pixelData[i]); fputs(" ",fp); fputs("\n",fp);
+    // Dimensions of the canvas in pixels
+    unsigned int getWidth() const { return width; }
+    unsigned int getHeight() const { return height; }
+
+    // The raw R,G,B bytes, row by row from the top.
+    // Rasterizers write whole rows through this rather than
+    // calling setPixelColor for every pixel.
+    unsigned char* getPixelData() { return m_pixelData; }
+
+    // Writes the image as a .tga file: uncompressed, or with run
+    // length encoding when rle is true. Returns false if the file
+    // could not be written, or the image is too big for the format
+    // (65535 pixels on a side).
+    bool outputTGAImage(std::string fileName, bool rle = false){
+        if(width > 65535 || height > 65535){
+            return false;
+        }
+        // 18 byte header. Fields we do not use (image ID, color map,
+        // origin) stay zero.
+        std::vector<unsigned char> file(18, 0);
+        file[2] = rle ? 10 : 2;              // True color, RLE or not
+        file[12] = width & 0xFF;
+        file[13] = (width >> 8) & 0xFF;
+        file[14] = height & 0xFF;
+        file[15] = (height >> 8) & 0xFF;
+        file[16] = 24;                       // Bits per pixel
+        file[17] = 0x20;                     // First row is the top one
+
+        // TGA stores pixels as B,G,R
+        if(!rle){
+            file.resize(18 + width * height * 3);
+            unsigned char* out = &file[18];
+            for(unsigned int i = 0; i < width * height; ++i){
+                out[i * 3] = m_pixelData[i * 3 + 2];
+                out[i * 3 + 1] = m_pixelData[i * 3 + 1];
+                out[i * 3 + 2] = m_pixelData[i * 3];
             }
-            fclose(fp);
-            myFile.close();
-       }
-         
+        }
+        else{
+            // Packets of up to 128 pixels, never crossing a row: a run
+            // packet repeats one pixel, a raw packet lists pixels.
+            for(unsigned int y = 0; y < height; ++y){
+                const unsigned char* row = m_pixelData + y * width * 3;
+                unsigned int x = 0;
+                while(x < width){
+                    unsigned int run = 1;
+                    while(x + run < width && run < 128 && samePixel(row, x, x + run)){
+                        ++run;
+                    }
+                    if(run > 1){
+                        file.push_back(0x80 | (run - 1));
+                        pushPixel(file, row + x * 3);
+                        x += run;
+                        continue;
+                    }
+                    // Raw pixels up to the next run of two
+                    unsigned int count = 1;
+                    while(x + count < width && count < 128 &&
+                          !(x + count + 1 < width && samePixel(row, x + count, x + count + 1))){
+                        ++count;
+                    }
+                    file.push_back(count - 1);
+                    for(unsigned int i = 0; i < count; ++i){
+                        pushPixel(file, row + (x + i) * 3);
+                    }
+                    x += count;
+                }
+            }
+        }
+        return writeFile(fileName, file);
     }
 
-    
+    // Writes the image as a binary (P6) .ppm file.
+    // Returns false if the file could not be written.
+    bool outputPPMImage(std::string fileName){
+        std::ostringstream header;
+        header << "P6\n" << width << " " << height << "\n255\n";
+        const std::string text = header.str();
+        std::vector<unsigned char> file(text.begin(), text.end());
+        file.insert(file.end(), m_pixelData, m_pixelData + width * height * 3);
+        return writeFile(fileName, file);
+    }
 
 private:
+    bool samePixel(const unsigned char* row, unsigned int a, unsigned int b) const{
+        return row[a * 3] == row[b * 3] && row[a * 3 + 1] == row[b * 3 + 1] && row[a * 3 + 2] == row[b * 3 + 2];
+    }
+
+    // Appends an R,G,B pixel as B,G,R
+    static void pushPixel(std::vector<unsigned char>& file, const unsigned char* pixel){
+        file.push_back(pixel[2]);
+        file.push_back(pixel[1]);
+        file.push_back(pixel[0]);
+    }
+
+    // Writes all of bytes to fileName in one go
+    static bool writeFile(const std::string& fileName, const std::vector<unsigned char>& bytes){
+        std::ofstream file(fileName.c_str(), std::ios::binary);
+        file.write((const char*)&bytes[0], bytes.size());
+        return (bool)file;
+    }
+
     unsigned char* m_pixelData;
     unsigned int width{0};
     unsigned int height{0};
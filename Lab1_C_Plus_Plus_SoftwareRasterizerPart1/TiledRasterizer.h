@@ -0,0 +1,144 @@
+#ifndef TILED_RASTERIZER_H
+#define TILED_RASTERIZER_H
+/** @file TiledRasterizer.h
+ *  @brief Filling many triangles on several threads at once
+ *
+ *  Note this is implemented as a header only library.
+ *
+ *  The canvas is cut into square tiles (32x32 or 64x64 pixels work
+ *  well). Each triangle added is recorded in the bin of every tile
+ *  its bounding box touches. render() then hands out whole tiles to
+ *  worker threads. A thread fills the triangles of its tile, in the
+ *  order they were added, clipped to the tile.
+ *
+ *  No two threads ever write the same tile, so the canvas needs no
+ *  locks. Each pixel is written in the order the triangles were
+ *  added, and fillTriangle covers the same pixels however the
+ *  triangle is clipped. The image is therefore identical to drawing
+ *  the triangles one after another, whatever the number of threads.
+ *
+ *  Programs using this need to link with -pthread.
+ *
+ *  @bug No known bugs.
+ */
+
+// Standard Libraries
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// User Libraries
+#include "Color.h"
+#include "Maths.h"
+#include "Rasterizer.h"
+#include "TGA.h"
+
+class TiledRasterizer{
+public:
+
+    // Constructor
+    // Bins for a width x height canvas cut into tileSize tiles.
+    TiledRasterizer(unsigned int _width, unsigned int _height, unsigned int _tileSize = 64){
+        width = _width;
+        height = _height;
+        tileSize = _tileSize;
+        tilesX = (width + tileSize - 1) / tileSize;
+        tilesY = (height + tileSize - 1) / tileSize;
+        bins.resize(tilesX * tilesY);
+    }
+
+    // Records a triangle to be drawn by the next render().
+    // Triangles completely off the canvas are dropped here.
+    void addTriangle(Vec2 v0, Vec2 v1, Vec2 v2, ColorRGB c){
+        const int minX = std::max(std::min(v0.x, std::min(v1.x, v2.x)), 0);
+        const int minY = std::max(std::min(v0.y, std::min(v1.y, v2.y)), 0);
+        const int maxX = std::min(std::max(v0.x, std::max(v1.x, v2.x)), (int)width - 1);
+        const int maxY = std::min(std::max(v0.y, std::max(v1.y, v2.y)), (int)height - 1);
+        if(minX > maxX || minY > maxY){
+            return;
+        }
+
+        Triangle t;
+        t.v0 = v0;
+        t.v1 = v1;
+        t.v2 = v2;
+        t.color = c;
+        const unsigned int index = triangles.size();
+        triangles.push_back(t);
+
+        for(unsigned int ty = minY / tileSize; ty <= maxY / tileSize; ++ty){
+            for(unsigned int tx = minX / tileSize; tx <= maxX / tileSize; ++tx){
+                bins[ty * tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    // Draws every triangle added since the last clear() into image,
+    // which must be the size given to the constructor.
+    // threadCount 0 uses one thread per core.
+    void render(TGA& image, unsigned int threadCount = 0){
+        if(threadCount == 0){
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        const unsigned int tileCount = tilesX * tilesY;
+        threadCount = std::min(threadCount, tileCount);
+
+        // Threads take the next unclaimed tile until none are left,
+        // so a few busy tiles do not hold up the rest.
+        std::atomic<unsigned int> nextTile(0);
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < threadCount; ++i){
+            workers.push_back(std::thread(&TiledRasterizer::renderTiles, this, std::ref(image), std::ref(nextTile)));
+        }
+        renderTiles(image, nextTile);
+        for(std::size_t i = 0; i < workers.size(); ++i){
+            workers[i].join();
+        }
+    }
+
+    // Forgets all the triangles, keeping the memory for the next frame
+    void clear(){
+        triangles.clear();
+        for(std::size_t i = 0; i < bins.size(); ++i){
+            bins[i].clear();
+        }
+    }
+
+    unsigned int getTileSize() const { return tileSize; }
+    std::size_t getTriangleCount() const { return triangles.size(); }
+
+private:
+    struct Triangle{
+        Vec2 v0, v1, v2;
+        ColorRGB color;
+    };
+
+    // Work loop of one thread
+    void renderTiles(TGA& image, std::atomic<unsigned int>& nextTile) const{
+        const unsigned int tileCount = tilesX * tilesY;
+        for(unsigned int tile = nextTile++; tile < tileCount; tile = nextTile++){
+            const int minX = (tile % tilesX) * tileSize;
+            const int minY = (tile / tilesX) * tileSize;
+            const int maxX = std::min(minX + (int)tileSize, (int)width) - 1;
+            const int maxY = std::min(minY + (int)tileSize, (int)height) - 1;
+            const std::vector<unsigned int>& bin = bins[tile];
+            for(std::size_t i = 0; i < bin.size(); ++i){
+                const Triangle& t = triangles[bin[i]];
+                fillTriangle(t.v0, t.v1, t.v2, image, t.color, minX, minY, maxX, maxY);
+            }
+        }
+    }
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int tileSize;
+    unsigned int tilesX;
+    unsigned int tilesY;
+    // Every triangle added, in order
+    std::vector<Triangle> triangles;
+    // Per tile, the indices of the triangles touching it, in order
+    std::vector<std::vector<unsigned int> > bins;
+};
+
+#endif
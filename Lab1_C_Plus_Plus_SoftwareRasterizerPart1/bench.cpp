@@ -0,0 +1,349 @@
+/** @file bench.cpp
+ *  @brief Triangles per second of the triangle fillers
+ *
+ *  Times fillTriangle from Rasterizer.h against the barycentric
+ *  loop main.cpp used before it, on random triangles of several
+ *  sizes, and checks that both cover nearly the same pixels.
+ *
+ *  Then times TiledRasterizer on a 10000 triangle scene with
+ *  1 to N threads, and checks it draws exactly what drawing the
+ *  triangles one by one does.
+ *
+ *  Next it times drawing the scene as a wireframe with drawLines
+ *  from Lines.h, against the float line loop main.cpp used before.
+ *
+ *  Then it records the scene, with polygon mode changes and
+ *  triangles that draw nothing mixed in, into a GLCommandQueue
+ *  from GL.h, and times flushing it against drawing each call at
+ *  once.
+ *
+ *  Last it times saving the scene image in each format TGA.h
+ *  writes, against the text .ppm writer it had before. The files
+ *  are written to the current directory and removed afterwards.
+ *
+ *  Compile on the terminal with:
+ *
+ *  clang++ -std=c++11 -O2 -pthread bench.cpp -o bench
+ *
+ *  Add -mavx2 to test 8 pixels with AVX2 rather than SSE2, or
+ *  -DRASTERIZER_NO_SIMD to time the plain C++ version.
+ *
+ *  @bug No known bugs.
+ */
+
+// C++ Standard Libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// User libraries
+#include "Color.h"
+#include "GL.h"
+#include "TGA.h"
+#include "Maths.h"
+#include "Lines.h"
+#include "Rasterizer.h"
+#include "TiledRasterizer.h"
+
+#define CANVAS_SIZE 1024
+
+float determinant(Vec2 v0, Vec2 v1) {
+  return (v0.x * v1.y) - (v0.y * v1.x);
+}
+
+// The barycentric fill main.cpp used before Rasterizer.h, kept here
+// as the baseline. It expects the triangle to lie inside the image.
+void barycentricTriangle(Vec2 v0, Vec2 v1, Vec2 v2, TGA& image, ColorRGB c) {
+  int maxX = std::max(v0.x, std::max(v1.x, v2.x));
+  int minX = std::min(v0.x, std::min(v1.x, v2.x));
+  int maxY = std::max(v0.y, std::max(v1.y, v2.y));
+  int minY = std::min(v0.y, std::min(v1.y, v2.y));
+
+  Vec2 vs1 = Vec2(v1.x - v0.x, v1.y - v0.y);
+  Vec2 vs2 = Vec2(v2.x - v0.x, v2.y - v0.y);
+
+  for (int x = minX; x <= maxX; x++) {
+    for (int y = minY; y <= maxY; y++) {
+      Vec2 q = Vec2(x - v0.x, y - v0.y);
+      float s = determinant(q, vs2) / determinant(vs1, vs2);
+      float t = determinant(vs1, q) / determinant(vs1, vs2);
+
+      if ((s >= 0) && (t >= 0) && (s + t <= 1)) {
+        image.setPixelColor(x, y, c);
+      }
+    }
+  }
+}
+
+// The line loop main.cpp used before Lines.h, kept here as the
+// baseline: a float division and conversion per pixel, no clipping.
+void floatLine(Vec2 v0, Vec2 v1, TGA& image, ColorRGB c) {
+  bool steep = false;
+  if (std::abs(v0.x - v1.x) < std::abs(v0.y - v1.y)) {
+    std::swap(v0.x, v0.y);
+    std::swap(v1.x, v1.y);
+    steep = true;
+  }
+  if (v0.x > v1.x) {
+    std::swap(v0.x, v1.x);
+    std::swap(v0.y, v1.y);
+  }
+  for (int x = v0.x; x <= v1.x; ++x) {
+    float t = (x - v0.x) / (float)(v1.x - v0.x);
+    int y = v0.y * (1.0f - t) + v1.y * t;
+    if (steep) {
+      image.setPixelColor(y, x, c);
+    }
+    else {
+      image.setPixelColor(x, y, c);
+    }
+  }
+}
+
+// The text (P3) .ppm writer TGA.h had before, kept here as the
+// baseline, with the image size fixed
+void textPPM(TGA& image, const char* fileName) {
+  FILE* fp = fopen(fileName, "w+");
+  fprintf(fp, "P3\n%u %u\n255\n", image.getWidth(), image.getHeight());
+  const unsigned char* pixels = image.getPixelData();
+  for (unsigned int i = 0; i < image.getWidth() * image.getHeight() * 3; i++) {
+    fprintf(fp, "%d", pixels[i]); fputs(" ", fp); fputs("\n", fp);
+  }
+  fclose(fp);
+}
+
+// Milliseconds to run save, best of 5
+template <typename Save>
+double bestMs(Save save) {
+  double best = 1e30;
+  for (int run = 0; run < 5; ++run) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    save();
+    best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+// Size of a file in bytes
+long fileSize(const char* fileName) {
+  FILE* fp = fopen(fileName, "rb");
+  if (!fp) {
+    return 0;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+// Random triangles whose vertices lie within 'size' pixels of
+// each other, all inside the canvas.
+std::vector<Vec2> makeTriangles(int count, int size) {
+  std::vector<Vec2> points;
+  for (int i = 0; i < count; ++i) {
+    int x = std::rand() % (CANVAS_SIZE - size);
+    int y = std::rand() % (CANVAS_SIZE - size);
+    for (int j = 0; j < 3; ++j) {
+      points.push_back(Vec2(x + std::rand() % (size + 1), y + std::rand() % (size + 1)));
+    }
+  }
+  return points;
+}
+
+// Triangles per second of fill over all of 'points', repeated until
+// at least a quarter of a second has passed
+template <typename Fill>
+double trianglesPerSecond(Fill fill, const std::vector<Vec2>& points, TGA& image) {
+  ColorRGB c; c.r = 255; c.g = 0; c.b = 0;
+  long long triangles = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double seconds = 0;
+  do {
+    for (std::size_t i = 0; i < points.size(); i += 3) {
+      c.g = (unsigned char)i;
+      fill(points[i], points[i + 1], points[i + 2], image, c);
+    }
+    triangles += points.size() / 3;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (seconds < 0.25);
+  return triangles / seconds;
+}
+
+// Number of pixels two images differ in
+int differentPixels(TGA& a, TGA& b) {
+  int count = 0;
+  const unsigned char* pa = a.getPixelData();
+  const unsigned char* pb = b.getPixelData();
+  for (unsigned int i = 0; i < a.getWidth() * a.getHeight(); ++i) {
+    if (pa[i * 3] != pb[i * 3] || pa[i * 3 + 1] != pb[i * 3 + 1] || pa[i * 3 + 2] != pb[i * 3 + 2]) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+int main() {
+  const int sizes[] = { 4, 16, 64, 256 };
+  TGA edgeImage(CANVAS_SIZE, CANVAS_SIZE);
+  TGA barycentricImage(CANVAS_SIZE, CANVAS_SIZE);
+
+  std::printf("%-8s %16s %16s %8s %12s\n", "size", "edge tri/s", "bary tri/s", "speedup", "diff pixels");
+  for (int size : sizes) {
+    std::srand(size);
+    std::vector<Vec2> points = makeTriangles(1000, size);
+
+    // fillTriangle is overloaded, pick the unclipped one
+    void (*edgeFill)(Vec2, Vec2, Vec2, TGA&, ColorRGB) = fillTriangle;
+    double edge = trianglesPerSecond(edgeFill, points, edgeImage);
+    double barycentric = trianglesPerSecond(barycentricTriangle, points, barycentricImage);
+
+    // Pixels on the shared edges differ: the barycentric test keeps
+    // every edge, the top-left rule only the top and left ones.
+    TGA a(CANVAS_SIZE, CANVAS_SIZE), b(CANVAS_SIZE, CANVAS_SIZE);
+    ColorRGB white; white.r = white.g = white.b = 255;
+    for (std::size_t i = 0; i < points.size(); i += 3) {
+      fillTriangle(points[i], points[i + 1], points[i + 2], a, white);
+      barycentricTriangle(points[i], points[i + 1], points[i + 2], b, white);
+    }
+    std::printf("%-8d %16.0f %16.0f %7.1fx %12d\n", size, edge, barycentric, edge / barycentric, differentPixels(a, b));
+  }
+
+  // A scene of 10000 triangles from 4 to 64 pixels across, each
+  // drawn over the ones before it
+  std::srand(2023);
+  std::vector<Vec2> scene;
+  std::vector<ColorRGB> colors;
+  for (int size = 4; size <= 64; size *= 2) {
+    std::vector<Vec2> points = makeTriangles(2000, size);
+    scene.insert(scene.end(), points.begin(), points.end());
+  }
+  for (std::size_t i = 0; i < scene.size(); i += 3) {
+    ColorRGB c; c.r = std::rand() % 256; c.g = std::rand() % 256; c.b = std::rand() % 256;
+    colors.push_back(c);
+  }
+
+  const int frames = 20;
+  TGA serialImage(CANVAS_SIZE, CANVAS_SIZE);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (std::size_t i = 0; i < scene.size(); i += 3) {
+      fillTriangle(scene[i], scene[i + 1], scene[i + 2], serialImage, colors[i / 3]);
+    }
+  }
+  double serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+  // At least 4 threads, so the cost of threading shows even on
+  // machines with fewer cores
+  unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 4u);
+  std::printf("\n%u triangles, %u cores, serial fillTriangle %.2f ms\n",
+    (unsigned int)colors.size(), std::thread::hardware_concurrency(), serialMs);
+  std::printf("%-6s %-8s %12s %8s %12s\n", "tile", "threads", "ms/frame", "speedup", "diff pixels");
+  const unsigned int tileSizes[] = { 32, 64 };
+  for (unsigned int tileSize : tileSizes) {
+    TiledRasterizer tiled(CANVAS_SIZE, CANVAS_SIZE, tileSize);
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+      TGA tiledImage(CANVAS_SIZE, CANVAS_SIZE);
+      start = std::chrono::steady_clock::now();
+      for (int frame = 0; frame < frames; ++frame) {
+        // Binning is part of every frame
+        tiled.clear();
+        for (std::size_t i = 0; i < scene.size(); i += 3) {
+          tiled.addTriangle(scene[i], scene[i + 1], scene[i + 2], colors[i / 3]);
+        }
+        tiled.render(tiledImage, threads);
+      }
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+      std::printf("%-6u %-8u %12.2f %7.2fx %12d\n", tileSize, threads, ms, serialMs / ms, differentPixels(serialImage, tiledImage));
+    }
+  }
+
+  // The scene's triangle edges as a list of lines
+  std::vector<Vec2> lines;
+  for (std::size_t i = 0; i < scene.size(); i += 3) {
+    const Vec2 edges[6] = { scene[i], scene[i + 1], scene[i + 1], scene[i + 2], scene[i + 2], scene[i] };
+    lines.insert(lines.end(), edges, edges + 6);
+  }
+  TGA lineImage(CANVAS_SIZE, CANVAS_SIZE);
+  ColorRGB white; white.r = white.g = white.b = 255;
+  double bresenhamMs = 1e30, floatMs = 1e30;
+  for (int run = 0; run < 5; ++run) {
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+      drawLines(&lines[0], lines.size(), lineImage, white);
+    }
+    bresenhamMs = std::min(bresenhamMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+      for (std::size_t i = 0; i < lines.size(); i += 2) {
+        floatLine(lines[i], lines[i + 1], lineImage, white);
+      }
+    }
+    floatMs = std::min(floatMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames);
+  }
+  std::printf("\nwireframe, %u lines: drawLines %.2f ms, float lines %.2f ms, %.1fx\n",
+    (unsigned int)(lines.size() / 2), bresenhamMs, floatMs, floatMs / bresenhamMs);
+
+  // The scene in batches of 500 triangles, every fifth batch in
+  // LINE mode, plus 1000 triangles off the canvas and 1000 of zero
+  // area spread through it
+  struct Call { Vec2 v[3]; ColorRGB c; int mode; };
+  std::vector<Call> calls;
+  for (std::size_t i = 0; i < scene.size(); i += 3) {
+    Call call = { { scene[i], scene[i + 1], scene[i + 2] }, colors[i / 3], (i / 3 / 500) % 5 == 4 ? LINE : FILL };
+    calls.push_back(call);
+    if (i / 3 % 5 == 0) {
+      Call offscreen = { { Vec2(-50, 10), Vec2(-10, 20), Vec2(-30, 90) }, colors[i / 3], call.mode };
+      Call degenerate = { { scene[i], scene[i + 1], scene[i] }, colors[i / 3], FILL };
+      calls.push_back(offscreen);
+      calls.push_back(degenerate);
+    }
+  }
+  TGA immediateImage(CANVAS_SIZE, CANVAS_SIZE);
+  double immediateMs = bestMs([&]() {
+    for (std::size_t i = 0; i < calls.size(); ++i) {
+      glPolygonMode(calls[i].mode);
+      if (glFillMode == LINE) {
+        Vec2 edges[6] = { calls[i].v[0], calls[i].v[1], calls[i].v[1], calls[i].v[2], calls[i].v[2], calls[i].v[0] };
+        drawLines(edges, 6, immediateImage, calls[i].c);
+      }
+      else {
+        fillTriangle(calls[i].v[0], calls[i].v[1], calls[i].v[2], immediateImage, calls[i].c);
+      }
+    }
+  });
+  std::printf("\n%u draw calls, immediate: %.2f ms\n", (unsigned int)calls.size(), immediateMs);
+  GLCommandQueue queue;
+  for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+    TGA queueImage(CANVAS_SIZE, CANVAS_SIZE);
+    double queueMs = bestMs([&]() {
+      for (std::size_t i = 0; i < calls.size(); ++i) {
+        queue.polygonMode(calls[i].mode);
+        queue.triangle(calls[i].v[0], calls[i].v[1], calls[i].v[2], calls[i].c);
+      }
+      queue.flush(queueImage, threads);
+    });
+    const GLCommandQueue::Stats& stats = queue.getStats();
+    std::printf("queue, %u threads: %.2f ms (%u culled off canvas, %u degenerate, %u batches), diff pixels %d\n",
+      threads, queueMs, (unsigned int)stats.culledOffscreen, (unsigned int)stats.culledDegenerate,
+      (unsigned int)stats.batches, differentPixels(immediateImage, queueImage));
+  }
+
+  std::printf("\nsaving the %dx%d scene image\n", CANVAS_SIZE, CANVAS_SIZE);
+  std::printf("%-16s %10s %12s\n", "format", "ms", "bytes");
+  double ms = bestMs([&]() { textPPM(serialImage, "bench_output_text.ppm"); });
+  std::printf("%-16s %10.2f %12ld\n", "text ppm (old)", ms, fileSize("bench_output_text.ppm"));
+  ms = bestMs([&]() { serialImage.outputPPMImage("bench_output.ppm"); });
+  std::printf("%-16s %10.2f %12ld\n", "binary ppm", ms, fileSize("bench_output.ppm"));
+  ms = bestMs([&]() { serialImage.outputTGAImage("bench_output.tga"); });
+  std::printf("%-16s %10.2f %12ld\n", "tga", ms, fileSize("bench_output.tga"));
+  ms = bestMs([&]() { serialImage.outputTGAImage("bench_output_rle.tga", true); });
+  std::printf("%-16s %10.2f %12ld\n", "tga rle", ms, fileSize("bench_output_rle.tga"));
+  std::remove("bench_output_text.ppm");
+  std::remove("bench_output.ppm");
+  std::remove("bench_output.tga");
+  std::remove("bench_output_rle.tga");
+  return 0;
+}
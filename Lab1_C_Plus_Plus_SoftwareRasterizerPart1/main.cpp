@@ -26,73 +26,21 @@
 #include "Color.h"
 #include "TGA.h"
 #include "Maths.h"
+#include "Lines.h"
+#include "Rasterizer.h"
 
 // Create a canvas to draw on.
 TGA canvas(WINDOW_WIDTH, WINDOW_HEIGHT);
 
 
-// Implementation of Bresenham's Line Algorithm
-// The input to this algorithm is two points and a color
-// This algorithm will then modify a canvas (i.e. image)
-// filling in the appropriate colors.
-void drawLine(Vec2 v0, Vec2 v1, TGA& image, ColorRGB c) {
-  bool steep = false;
-  if (std::abs(v0.x - v1.x) < std::abs(v0.y - v1.y)) {
-    // If the line is steep we want to transpose the image.
-    std::swap(v0.x, v0.y);
-    std::swap(v1.x, v1.y);
-    steep = true;
-  }
-  if (v0.x > v1.x) {  // make it left-to-right
-    std::swap(v0.x, v1.x);
-    std::swap(v0.y, v1.y);
-  }
-  for (int x = v0.x; x <= v1.x; ++x) {
-    float t = (x - v0.x) / (float)(v1.x - v0.x);
-    int y = v0.y * (1.0f - t) + v1.y * t;
-    if (steep) {
-      canvas.setPixelColor(y, x, c);
-    }
-    else {
-      canvas.setPixelColor(x, y, c);
-    }
-  }
-}
-
-float determinant(Vec2 v0, Vec2 v1) {
-  return (v0.x * v1.y) - (v0.y * v1.x);
-}
-
 // Draw a triangle
 void triangle(Vec2 v0, Vec2 v1, Vec2 v2, TGA& image, ColorRGB c) {
-  if (glFillMode == LINE) {
-    drawLine(v0, v1, image, c);
-    drawLine(v1, v2, image, c);
-    drawLine(v2, v0, image, c);
+  if (glFillMode == LINE) { // Bresenham, see Lines.h
+    Vec2 edges[6] = { v0, v1, v1, v2, v2, v0 };
+    drawLines(edges, 6, image, c);
   }
-  else if (glFillMode == FILL) { // Barycentric Algorithm
-    // Bounding box of triangle
-    int maxX = std::max(v0.x, std::max(v1.x, v2.x));
-    int minX = std::min(v0.x, std::min(v1.x, v2.x));
-    int maxY = std::max(v0.y, std::max(v1.y, v2.y));
-    int minY = std::min(v0.y, std::min(v1.y, v2.y));
-
-    // Spanning vectors of edges (v0, v1) and (v1, v2)
-    Vec2 vs1 = Vec2(v1.x - v0.x, v1.y - v0.y);
-    Vec2 vs2 = Vec2(v2.x - v0.x, v2.y - v0.y);
-
-    // Loop through points in bounding box and draw the ones inside the triangle
-    for (int x = minX; x <= maxX; x++) {
-      for (int y = minY; y <= maxY; y++) {
-        Vec2 q = Vec2(x - v0.x, y - v0.y);
-        float s = determinant(q, vs2) / determinant(vs1, vs2);
-        float t = determinant(vs1, q) / determinant(vs1, vs2);
-
-        if ((s >= 0) && (t >= 0) && (s + t <= 1)) {
-          canvas.setPixelColor(x, y, c);
-        }
-      }
-    }
+  else if (glFillMode == FILL) { // Edge functions, see Rasterizer.h
+    fillTriangle(v0, v1, v2, image, c);
   }
 }
 
@@ -119,7 +67,7 @@ int main() {
   triangle(triangle3[0], triangle3[1], triangle3[2], canvas, darkGreen);
 
   // Output the final image
-  canvas.outputTGAImage("graphics_lab2.ppm");
+  canvas.outputPPMImage("graphics_lab2.ppm");
 
   return 0;
 }
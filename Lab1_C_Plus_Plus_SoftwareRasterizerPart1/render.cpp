@@ -0,0 +1,222 @@
+/** @file render.cpp
+ *  @brief Renders an .obj model to an image, without a window.
+ *
+ *  Draws the model with a depth buffer, interpolating its normals
+ *  with perspective correction for simple diffuse lighting, and
+ *  writes the result as a .ppm image.
+ *
+ *  It then draws the model again with its triangles in file order,
+ *  sorted front to back and sorted back to front, each without and
+ *  with early-z, and prints how many pixels were depth tested and
+ *  shaded. Overdraw is the number of pixels shaded per pixel visible
+ *  in the image. "Shading saved" is the share of covered pixels the
+ *  depth test kept from being shaded, and "tests skipped" the share
+ *  early-z kept from even being tested.
+ *
+ *  Compile on the terminal with:
+ *
+ *  clang++ -std=c++11 -O2 render.cpp -o render
+ *
+ *  and run with:
+ *
+ *  ./render [model.obj] [image.ppm]
+ *
+ *  By default it draws ../objects/bunny.obj to render.ppm.
+ *
+ *  @bug No known bugs.
+ */
+
+// Some define values
+#define WINDOW_HEIGHT 320
+#define WINDOW_WIDTH 320
+
+// C++ Standard Libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// User libraries
+#include "Color.h"
+#include "DepthBuffer.h"
+#include "Maths.h"
+#include "ObjModel.h"
+#include "Rasterizer3D.h"
+#include "TGA.h"
+
+// The model's triangles, projected and ready to fill
+struct ScreenTriangle{
+    ScreenVertex v[3];
+    float nearest;  // Smallest z of the three vertices
+};
+
+// Diffuse lighting from the interpolated normal in attributes 0..2
+struct DiffuseShader{
+    Vec3f light;
+    ColorRGB operator()(const float* attributes) const{
+        Vec3f n = normalize(Vec3f(attributes[0], attributes[1], attributes[2]));
+        float intensity = 0.15f + 0.85f * std::max(dot(n, light), 0.0f);
+        ColorRGB c;
+        c.r = (unsigned char)(230 * intensity);
+        c.g = (unsigned char)(190 * intensity);
+        c.b = (unsigned char)(150 * intensity);
+        return c;
+    }
+};
+
+// Rotates, places and projects the model so it fills most of the
+// image, turned a little to the side.
+std::vector<ScreenTriangle> projectModel(const ObjModel& model, int width, int height){
+    const std::vector<Vec3f>& positions = model.getPositions();
+    Vec3f low = positions[0], high = positions[0];
+    for(std::size_t i = 0; i < positions.size(); ++i){
+        low = Vec3f(std::min(low.x, positions[i].x), std::min(low.y, positions[i].y), std::min(low.z, positions[i].z));
+        high = Vec3f(std::max(high.x, positions[i].x), std::max(high.y, positions[i].y), std::max(high.z, positions[i].z));
+    }
+    const Vec3f center = (low + high) * 0.5f;
+    const float radius = std::sqrt(dot(high - low, high - low)) * 0.5f;
+
+    // Camera on the +z axis looking at the center, 45 degree field of view
+    const float angle = 0.5f;
+    const float cosA = std::cos(angle), sinA = std::sin(angle);
+    const float focal = 1.0f / std::tan(0.5f * 0.785398f);
+    const float distance = radius * focal * 1.1f;
+    const float zNear = distance - radius * 1.5f > 0.01f * radius ? distance - radius * 1.5f : 0.01f * radius;
+    const float zFar = distance + radius * 1.5f;
+    const float aspect = (float)width / height;
+
+    // Rotation about y, to camera space and then to clip space
+    std::vector<float> clip(positions.size() * 4);
+    for(std::size_t i = 0; i < positions.size(); ++i){
+        Vec3f p = positions[i] - center;
+        float x = cosA * p.x + sinA * p.z;
+        float z = -sinA * p.x + cosA * p.z - distance;
+        clip[i * 4] = x * focal / aspect;
+        clip[i * 4 + 1] = p.y * focal;
+        clip[i * 4 + 2] = (z * (zFar + zNear) + 2 * zFar * zNear) / (zNear - zFar);
+        clip[i * 4 + 3] = -z;
+    }
+
+    const std::vector<Vec3f>& normals = model.getNormals();
+    const std::vector<ObjModel::Corner>& corners = model.getCorners();
+    std::vector<ScreenTriangle> triangles;
+    for(std::size_t t = 0; t + 2 < corners.size(); t += 3){
+        // Face normal for corners without one
+        const Vec3f faceNormal = normalize(cross(positions[corners[t + 1].position] - positions[corners[t].position],
+                                                 positions[corners[t + 2].position] - positions[corners[t].position]));
+        ScreenTriangle triangle;
+        bool visible = true;
+        for(int i = 0; i < 3; ++i){
+            const ObjModel::Corner& corner = corners[t + i];
+            Vec3f n = corner.normal >= 0 ? normals[corner.normal] : faceNormal;
+            float attributes[3] = { cosA * n.x + sinA * n.z, n.y, -sinA * n.x + cosA * n.z };
+            const float* c = &clip[corner.position * 4];
+            visible = visible && toScreen(c[0], c[1], c[2], c[3], attributes, 3, width, height, triangle.v[i]);
+        }
+        if(visible){
+            triangle.nearest = std::min(triangle.v[0].z, std::min(triangle.v[1].z, triangle.v[2].z));
+            triangles.push_back(triangle);
+        }
+    }
+    return triangles;
+}
+
+// Draws all the triangles and returns the milliseconds it took, best
+// of a few runs
+double draw(const std::vector<ScreenTriangle>& triangles, TGA& image, DepthBuffer& depth, RasterStats& stats){
+    DiffuseShader shader;
+    shader.light = normalize(Vec3f(0.4f, 0.6f, 1.0f));
+    double best = 0;
+    for(int run = 0; run < 5; ++run){
+        std::memset(image.getPixelData(), 0, image.getWidth() * image.getHeight() * 3);
+        depth.clear();
+        stats = RasterStats();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < triangles.size(); ++i){
+            const ScreenTriangle& t = triangles[i];
+            fillTriangle3D(t.v[0], t.v[1], t.v[2], 3, shader, image, depth, stats);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+bool nearerFirst(const ScreenTriangle& a, const ScreenTriangle& b){
+    return a.nearest < b.nearest;
+}
+
+bool fartherFirst(const ScreenTriangle& a, const ScreenTriangle& b){
+    return a.nearest > b.nearest;
+}
+
+// Main
+int main(int argc, char** argv){
+    std::string modelFile = argc > 1 ? argv[1] : "../objects/bunny.obj";
+    std::string imageFile = argc > 2 ? argv[2] : "render.ppm";
+
+    ObjModel model;
+    if(!model.load(modelFile) || model.getTriangleCount() == 0){
+        std::printf("Unable to load a model from %s\n", modelFile.c_str());
+        return 1;
+    }
+
+    TGA image(WINDOW_WIDTH, WINDOW_HEIGHT);
+    DepthBuffer depth(WINDOW_WIDTH, WINDOW_HEIGHT);
+    std::vector<ScreenTriangle> triangles = projectModel(model, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    RasterStats stats;
+    draw(triangles, image, depth, stats);
+    image.outputPPMImage(imageFile);
+
+    // Pixels the model shows in
+    long long visible = 0;
+    for(int y = 0; y < WINDOW_HEIGHT; ++y){
+        for(int x = 0; x < WINDOW_WIDTH; ++x){
+            visible += depth.getDepth(x, y) < 1.0f;
+        }
+    }
+    std::printf("%s: %u triangles, %lld visible pixels at %dx%d, written to %s\n\n",
+        modelFile.c_str(), (unsigned int)model.getTriangleCount(), visible, WINDOW_WIDTH, WINDOW_HEIGHT, imageFile.c_str());
+
+    std::printf("%-14s %-8s %8s %11s %11s %9s %9s %9s %9s\n",
+        "order", "early-z", "ms", "blocks hid", "depth tests", "shaded", "overdraw", "shading", "tests");
+    std::printf("%-14s %-8s %8s %11s %11s %9s %9s %9s %9s\n",
+        "", "", "", "", "", "", "", "saved", "skipped");
+    const char* orders[] = { "file", "front-to-back", "back-to-front" };
+    const std::size_t bytes = WINDOW_WIDTH * WINDOW_HEIGHT * 3;
+    std::vector<unsigned char> withoutEarlyZ(bytes);
+    for(int order = 0; order < 3; ++order){
+        if(order == 1){
+            std::stable_sort(triangles.begin(), triangles.end(), nearerFirst);
+        }
+        else if(order == 2){
+            std::stable_sort(triangles.begin(), triangles.end(), fartherFirst);
+        }
+        // Without early-z every covered pixel is depth tested, and
+        // without a depth test every one would be shaded
+        long long covered = 0;
+        for(int earlyZ = 0; earlyZ <= 1; ++earlyZ){
+            depth.setEarlyZ(earlyZ != 0);
+            double ms = draw(triangles, image, depth, stats);
+            if(!earlyZ){
+                covered = stats.pixelsCovered;
+                std::memcpy(&withoutEarlyZ[0], image.getPixelData(), bytes);
+            }
+            else if(std::memcmp(&withoutEarlyZ[0], image.getPixelData(), bytes) != 0){
+                std::printf("Early-z changed the image\n");
+                return 1;
+            }
+            std::printf("%-14s %-8s %8.2f %11lld %11lld %9lld %9.2f %8.0f%% %8.0f%%\n",
+                orders[order], earlyZ ? "on" : "off", ms, stats.blocksHidden,
+                stats.pixelsCovered, stats.pixelsShaded,
+                (double)stats.pixelsShaded / visible,
+                100.0 * (covered - stats.pixelsShaded) / covered,
+                100.0 * (covered - stats.pixelsCovered) / covered);
+        }
+    }
+    return 0;
+}
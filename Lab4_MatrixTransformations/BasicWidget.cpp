@@ -5,6 +5,19 @@ BasicWidget::BasicWidget(QWidget* parent) : QWidget(parent), buffer_(800, 600),
   prevTicks_ = QDateTime::currentMSecsSinceEpoch();
   yAxisRotation_ = 0.0f;
   projection_.InitPerspective(90.0f, 800./600., 0.1f, 1000.0f);
+
+  // The monkey, copied next to the executable by CMake. Without it
+  // we fall back to the single triangle.
+  if(!mesh_.LoadOBJ("objects/monkey.obj") || mesh_.triangleCount() == 0){
+    qDebug() << "Unable to load objects/monkey.obj, drawing a triangle instead.";
+    mesh_ = Mesh();
+    mesh_.AddVertex(maxYVert_);
+    mesh_.AddVertex(midYVert_);
+    mesh_.AddVertex(minYVert_);
+    mesh_.AddTriangle(0, 1, 2);
+  }
+  Vertex center = mesh_.Center();
+  center_.InitTranslation(-center.GetX(), -center.GetY(), -center.GetZ());
 }
 
 BasicWidget::~BasicWidget()
@@ -31,13 +44,12 @@ void BasicWidget::paintEvent(QPaintEvent* event)
   rotation_.InitRotation(0.0, yAxisRotation_, 0.0);
 
   // Apply our transforms
-  transform_ = projection_.Multiply(translation_.Multiply(rotation_));
+  transform_ = projection_.Multiply(translation_.Multiply(rotation_.Multiply(center_)));
 
+  // The buffer transforms each vertex of the mesh once, then fills
+  // the triangles that face us
   buffer_.clearImage();
-  Vertex v0 = maxYVert_.Transform(transform_);
-  Vertex v1 = midYVert_.Transform(transform_);
-  Vertex v2 = minYVert_.Transform(transform_);
-  buffer_.FillTriangle(v0, v1, v2);
+  buffer_.FillMesh(mesh_.vertices(), mesh_.indices(), transform_);
 
   QPainter painter(this);
   QImage image = buffer_.image();
@@ -6,6 +6,7 @@
 
 #include "ScanBuffer.h"
 #include "Matrix4f.h"
+#include "Mesh.h"
 #include "Vertex.h"
 
 /**
@@ -24,9 +25,12 @@ protected:
   Matrix4f rotation_;
   Matrix4f transform_;
   Matrix4f projection_;
+  // Moves the model's center to the origin, so it spins in place
+  Matrix4f center_;
   Vertex minYVert_;
   Vertex midYVert_;
   Vertex maxYVert_;
+  Mesh mesh_;
   
   // Paint our image.
   void paintEvent(QPaintEvent* event) Q_DECL_OVERRIDE;
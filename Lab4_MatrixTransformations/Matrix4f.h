@@ -1,6 +1,11 @@
 #ifndef MATRIX4F_H
 #define MATRIX4F_H
 
+// A thin adapter over the shared MathLib::Matrix4f (../MathLib),
+// keeping this lab's Init/Get/Set style. m_(i,j) is row i, column j.
+#include <cmath> // tan, M_PI
+#include "Vector4f.h"
+#include "MathLib/Matrix4f.h"
 
 class Matrix4f{
 public:
@@ -11,10 +16,7 @@ public:
 
     // Compute the identity matrix
     void Identity(){
-        m[0][0] = 1;    m[0][1] = 0; m[0][2] = 0; m[0][3] = 0;
-        m[1][0] = 0;    m[1][1] = 1; m[1][2] = 0; m[1][3] = 0;
-        m[2][0] = 0;    m[2][1] = 0; m[2][2] = 1; m[2][3] = 0;
-        m[3][0] = 0;    m[3][1] = 0; m[3][2] = 0; m[3][3] = 1;
+        m_ = MathLib::Matrix4f::MakeIdentity();
     }
 
 	// Probably something we do not need for OpenGL
@@ -26,44 +28,32 @@ public:
 	// and halfHeight as well.
 	// We make the halfHeight negative at [1][1] because 0 is the top of the screen. 
 	void InitScreenSpaceTransform(float halfWidth,float halfHeight){
-        m[0][0] = halfWidth;    m[0][1] = 0; 			m[0][2] = 0; m[0][3] = halfWidth;
-        m[1][0] = 0;    		m[1][1] = -halfHeight; 	m[1][2] = 0; m[1][3] = halfHeight;
-        m[2][0] = 0;    		m[2][1] = 0; 			m[2][2] = 1; m[2][3] = 0;
-        m[3][0] = 0;    		m[3][1] = 0; 			m[3][2] = 0; m[3][3] = 1;
+        m_ = MathLib::Matrix4f(
+            halfWidth,  0,              0, halfWidth,
+            0,          -halfHeight,    0, halfHeight,
+            0,          0,              1, 0,
+            0,          0,              0, 1);
 	}
 
     void InitTranslation(float x, float y, float z) {
-        m[0][0] = 1;   m[0][1] = 0;   m[0][2] = 0;   m[0][3] = x;
-        m[1][0] = 0;   m[1][1] = 1;   m[1][2] = 0;   m[1][3] = y;
-        m[2][0] = 0;   m[2][1] = 0;   m[2][2] = 1;   m[2][3] = z;
-        m[3][0] = 0;   m[3][1] = 0;   m[3][2] = 0;   m[3][3] = 1;
+        m_ = MathLib::Matrix4f(
+            1, 0, 0, x,
+            0, 1, 0, y,
+            0, 0, 1, z,
+            0, 0, 0, 1);
     }
 
     // x,y,z as angles
     void InitRotation(float x, float y, float z){
-        // Create three matrices to rotate around.
-        Matrix4f rx;
-        Matrix4f ry;
-        Matrix4f rz;
-        
-        rz.Set(0,0,cos(z));   rz.Set(0,1,sin(z));   rz.Set(0,2,0);        rz.Set(0,3,0); 
-        rz.Set(1,0,-sin(z));  rz.Set(1,1,cos(z));   rz.Set(1,2,0);        rz.Set(1,3,0);
-        rz.Set(2,0,0);        rz.Set(2,1,0);        rz.Set(2,2,1);        rz.Set(2,3,0);
-        rz.Set(3,0,0);        rz.Set(3,1,0);        rz.Set(3,2,0);        rz.Set(3,3,1);
-    
-        rx.Set(0,0,1);        rx.Set(0,1,0);        rx.Set(0,2,0);        rx.Set(0,3,0); 
-        rx.Set(1,0,0);        rx.Set(1,1,cos(x));   rx.Set(1,2,sin(x));   rx.Set(1,3,0);
-        rx.Set(2,0,0);        rx.Set(2,1,-sin(x));  rx.Set(2,2,cos(x));   rx.Set(2,3,0);
-        rx.Set(3,0,0);        rx.Set(3,1,0);        rx.Set(3,2,0);        rx.Set(3,3,1);
-
-        ry.Set(0,0,cos(y));   ry.Set(0,1,0);        ry.Set(0,2,-sin(y));  ry.Set(0,3,0); 
-        ry.Set(1,0,0);        ry.Set(1,1,1);        ry.Set(1,2,0);        ry.Set(1,3,0);
-        ry.Set(2,0,sin(y));   ry.Set(2,1,0);        ry.Set(2,2,cos(y));   ry.Set(2,3,0);
-        ry.Set(3,0,0);        ry.Set(3,1,0);        ry.Set(3,2,0);        ry.Set(3,3,1);
-  
+        // Three matrices to rotate around, laid out as before:
+        // MathLib's MakeRotationX/Y/Z match the rx, ry and rz this
+        // lab used to fill in by hand.
+        MathLib::Matrix4f rx = MathLib::Matrix4f::MakeRotationX(x);
+        MathLib::Matrix4f ry = MathLib::Matrix4f::MakeRotationY(y);
+        MathLib::Matrix4f rz = MathLib::Matrix4f::MakeRotationZ(z);
+
         // Multiply the matrices
-        // Copy values into 'm'
-        SetMatrix(rz.Multiply(ry.Multiply(rx))); 
+        m_ = MathLib::Multiply(rz, MathLib::Multiply(ry, rx));
     }
     
     // Initialize at a scale.
@@ -75,11 +65,11 @@ public:
     void InitPerspective(float fov, float aspectRatio, float zNear, float zFar){
         float tanHalfFOV = tan(fov/2 * M_PI / 180);    
         float zRange = zNear - zFar;
-        m[0][0] = 1.0f/(tanHalfFOV*aspectRatio);m[0][1] = 0;                m[0][2] = 0; m[0][3] = 0;
-        m[1][0] = 0;                            m[1][1] = 1.0f/tanHalfFOV;  m[1][2] = 0; m[1][3] = 0;
-        m[2][0] = 0;                            m[2][1] = 0;                m[2][2] = (-zNear-zFar)/zRange; m[2][3] =
-2*zFar*zNear/zRange;
-        m[3][0] = 0;                            m[3][1] = 0;                m[3][2] = 1; m[3][3] = 1;
+        m_ = MathLib::Matrix4f(
+            1.0f/(tanHalfFOV*aspectRatio),  0,                  0,                      0,
+            0,                              1.0f/tanHalfFOV,    0,                      0,
+            0,                              0,                  (-zNear-zFar)/zRange,   2*zFar*zNear/zRange,
+            0,                              0,                  1,                      1);
     }
 
     // Initialize Orthographic Matrix.
@@ -90,55 +80,36 @@ public:
     // Transform here is simply returning a 'new' vector
     // which will move our 'vertex' to a new position.
 	Vector4f Transform(Vector4f b) {
-        return Vector4f(
-            m[0][0] * b.GetX() + m[0][1] * b.GetY() + m[0][2] * b.GetZ() + m[0][3] * b.GetW(),
-            m[1][0] * b.GetX() + m[1][1] * b.GetY() + m[1][2] * b.GetZ() + m[1][3] * b.GetW(),
-            m[2][0] * b.GetX() + m[2][1] * b.GetY() + m[2][2] * b.GetZ() + m[2][3] * b.GetW(),
-            m[3][0] * b.GetX() + m[3][1] * b.GetY() + m[3][2] * b.GetZ() + m[3][3] * b.GetW());
+        return Vector4f(m_ * b.Get());
 	}
 
 
-    // Here is an example of how to do a slow matrix multiplication with loops.
-    // (Note: It is possible a smart enough compiler would unroll the values, but
-    //        typically it is best to explicitly perform the individual dot products).
+    // Matrix multiplication, done by MathLib's SSE kernel.
     Matrix4f Multiply(Matrix4f b){
         Matrix4f result;
-        for(int i=0; i < 4; i++){
-            for(int j =0; j < 4; j++){
-                float dot = m[i][0] * b.Get(0,j)+
-                            m[i][1] * b.Get(1,j)+
-                            m[i][2] * b.Get(2,j)+
-                            m[i][3] * b.Get(3,j);
-                result.Set(i,j,dot); 
-            }
-        }
-
+        result.m_ = MathLib::Multiply(m_, b.m_);
         return result;
     }
     
     // Set index of matrix to a value
     void Set(unsigned int i, unsigned int j, float value){
-        m[i][j] = value;
+        m_(i, j) = value;
     }
 
     // Retrieve value matrix.
     float Get(unsigned int i, unsigned int j){
-        return m[i][j];
+        return m_(i, j);
     }
 
     // Set the matrix values of internal matrix 'm' to
     // those of another.
     void SetMatrix(Matrix4f b){
-        for(int i=0; i < 4; i++){
-            for(int j=0; j < 4; j++){
-                m[i][j] = b.Get(i,j);
-            }
-        }
+        m_ = b.m_;
     }
     
 
 private:
-    float m[4][4];
+    MathLib::Matrix4f m_;
 };
 
 #endif
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QtCore>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Vertex.h"
+
+// An indexed triangle mesh. Each vertex is stored once, and every
+// three indices name the vertices of one triangle, so vertices shared
+// by several triangles only need to be transformed once.
+class Mesh{
+public:
+
+  // Reads the positions (v) and faces (f) of a .obj file, replacing
+  // what the mesh held. Faces with more than three corners are split
+  // into a fan. Returns false if the file could not be opened.
+  bool LoadOBJ(const std::string& fileName){
+    std::ifstream file(fileName.c_str());
+    if(!file.is_open()){
+      return false;
+    }
+    vertices_.clear();
+    indices_.clear();
+
+    std::string line;
+    while(std::getline(file, line)){
+      std::istringstream stream(line);
+      std::string type;
+      stream >> type;
+      if(type == "v"){
+        float x = 0, y = 0, z = 0;
+        stream >> x >> y >> z;
+        AddVertex(Vertex(x, y, z));
+      }
+      else if(type == "f"){
+        // Only the position of "v", "v/vt", "v//vn" or "v/vt/vn";
+        // atoi stops at the first '/'
+        QVector<int> face;
+        std::string corner;
+        while(stream >> corner){
+          int index = std::atoi(corner.c_str());
+          // .obj counts from 1, or back from the end when negative
+          index = index < 0 ? vertices_.size() + index : index - 1;
+          if(index < 0 || index >= vertices_.size()){
+            face.clear();
+            break;
+          }
+          face.push_back(index);
+        }
+        for(int i = 2; i < face.size(); i++){
+          AddTriangle(face[0], face[i - 1], face[i]);
+        }
+      }
+    }
+    return true;
+  }
+
+  void AddVertex(const Vertex& vertex){
+    vertices_.push_back(vertex);
+  }
+
+  void AddTriangle(int a, int b, int c){
+    indices_.push_back(a);
+    indices_.push_back(b);
+    indices_.push_back(c);
+  }
+
+  // Middle of the box around all the vertices
+  Vertex Center() const {
+    if(vertices_.isEmpty()){
+      return Vertex();
+    }
+    Vertex first = vertices_[0];
+    float low[3] = { first.GetX(), first.GetY(), first.GetZ() };
+    float high[3] = { low[0], low[1], low[2] };
+    for(int i = 1; i < vertices_.size(); i++){
+      Vertex v = vertices_[i];
+      float p[3] = { v.GetX(), v.GetY(), v.GetZ() };
+      for(int k = 0; k < 3; k++){
+        low[k] = std::min(low[k], p[k]);
+        high[k] = std::max(high[k], p[k]);
+      }
+    }
+    return Vertex((low[0] + high[0]) / 2, (low[1] + high[1]) / 2, (low[2] + high[2]) / 2);
+  }
+
+  const QVector<Vertex>& vertices() const {return vertices_;}
+  const QVector<int>& indices() const {return indices_;}
+  int triangleCount() const {return indices_.size() / 3;}
+
+private:
+  QVector<Vertex> vertices_;
+  QVector<int> indices_;
+};
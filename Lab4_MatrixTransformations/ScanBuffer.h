@@ -3,6 +3,10 @@
 #include <QtCore>
 #include <QtGui>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "Vertex.h"
 #include "Matrix4f.h"
 #include "Vector4f.h"
@@ -10,8 +14,10 @@
 class ScanBuffer{
 public:
 
-  ScanBuffer(int width, int height) : image_(width, height, QImage::Format_RGB888){
+  ScanBuffer(int width, int height) : image_(width, height, QImage::Format_RGB888), size_(width, height){
 	image_.fill(QColor(0,0,0));
+    screenSpaceTransform_.InitScreenSpaceTransform(width/2, height/2);
+    setFillColor(QColor(255, 255, 255));
     for(int i =0; i < height; i++){
       m_scanBufferMin.push_back(0);
       m_scanBufferMax.push_back(0);
@@ -25,111 +31,358 @@ public:
     m_scanBufferMax[yCoord] = xMax;
   }
 
+  // Fills every row from yMin up to yMax between its scan buffer
+  // min and max. Each row's pixels are reached through one scanLine()
+  // pointer and written as a single span, rather than calling
+  // setPixelColor (bounds check, color conversion, detach check)
+  // per pixel. Parts off the image are skipped, as setPixelColor did.
   void FillShape(int yMin, int yMax){
+    // FillSpan writes 3 bytes per pixel
+    Q_ASSERT(image_.format() == QImage::Format_RGB888);
+    yMin = std::max(yMin, 0);
+    yMax = std::min(yMax, std::min(image_.height(), m_scanBufferMin.size()));
     for(int j = yMin; j < yMax; j++){
-      // Get the min and hte max value at the y-position
-      int xMin = m_scanBufferMin[j];
-	  int xMax = m_scanBufferMax[j];
-            
-	  for(int i = xMin; i < xMax; i++){
-		image_.setPixelColor(i, j, QColor(255, 255, 255));
-	  }
-	}
+      // Get the min and the max value at the y-position
+      int xMin = std::max(m_scanBufferMin[j], 0);
+      int xMax = std::min(m_scanBufferMax[j], image_.width());
+      if(xMin >= xMax){
+        continue;
+      }
+      uchar* row = image_.scanLine(j);
+      FillSpan(row + xMin * 3, xMax - xMin);
+    }
   }
 
-    
+  // Color FillShape fills with, white by default
+  void setFillColor(const QColor& color){
+    fillColor_[0] = color.red();
+    fillColor_[1] = color.green();
+    fillColor_[2] = color.blue();
+  }
+
+
+  // Vertices are snapped to 1/16 of a pixel (28.4 fixed point) before
+  // their edges are walked. Every triangle sharing an edge then walks
+  // exactly the same edge, so meshes have no cracks and no pixels
+  // drawn twice.
+  static const int SUBPIXEL_BITS = 4;
+  static const int SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+
+  // Triangles are only clipped where they reach this many pixels past
+  // the image, or cross the near plane. Closer than that, rows and
+  // spans off the image are just skipped, which is much cheaper.
+  // It also keeps the fixed point math well within 64 bits.
+  static const int GUARD_BAND = 4096;
+
+  // A screen space vertex, in 28.4 fixed point
+  struct FixedPoint{
+    long long x;
+    long long y;
+  };
+
   // whichSide -- means which side of
   // scanbuffer(min or max) are we drawing on.
-  void ScanConvertLine(Vertex minYVert, Vertex maxYVert, int whichSide){
-	int xStart  = (int)minYVert.GetX();
-	int xEnd    = (int)maxYVert.GetX();
-    
-	int yStart  = (int)minYVert.GetY();
-	int yEnd    = (int)maxYVert.GetY();
+  //
+  // A pixel is filled when its center (i + 1/2, j + 1/2) is inside
+  // the triangle, or on its top or left edge ("top-left rule"). So
+  // the edge covers the rows whose centers are at or below its top
+  // and above its bottom, and on each row we store the first column
+  // whose center is at or right of the edge. The left edge's column
+  // is filled and the right edge's is not.
+  void ScanConvertLine(FixedPoint minYVert, FixedPoint maxYVert, int whichSide){
+	long long yStart = FirstRow(minYVert.y);
+	long long yEnd   = FirstRow(maxYVert.y);
 	
-	int yDist = yEnd - yStart;
-	int xDist = xEnd - xStart;
+	// Only the rows of the image
+	yStart = std::max(yStart, 0LL);
+	yEnd = std::min(yEnd, (long long)m_scanBufferMin.size());
 	
 	// No work to be done
-	if(yDist <= 0){
+	if(yEnd <= yStart){
 	  return;
 	}
 	
-	float xStep = (float)xDist/(float)yDist; // how far along x-axis are we moving.as we go down
-	// are we moving to the left or the right.
+	// Row j's center crosses the edge at N(j) / D pixel centers from
+	// the left, with
+	//   N(j) = (16 j + 8 - y0) (x1 - x0) + (x0 - 8) (y1 - y0)
+	//   D    = 16 (y1 - y0)
+	// and the column we want is N(j) / D rounded up. Keep that and
+	// the remainder, and step both exactly from row to row.
+	long long xDist = maxYVert.x - minYVert.x;
+	long long yDist = maxYVert.y - minYVert.y;
+	long long D = SUBPIXEL_ONE * yDist;
+	long long N = (SUBPIXEL_ONE * yStart + SUBPIXEL_ONE / 2 - minYVert.y) * xDist
+	            + (minYVert.x - SUBPIXEL_ONE / 2) * yDist;
+	long long curX = CeilDivide(N, D);
+	long long remainder = curX * D - N;
 	
-	// Where we start from
-	float curX = (float)xStart;
+	long long step = SUBPIXEL_ONE * xDist;
+	long long xStep = FloorDivide(step, D);
+	long long remainderStep = step - xStep * D;
 	
-	for(int j = yStart; j < yEnd; j++){
-	  if(whichSide==0){
-		m_scanBufferMin[j] = curX;
-	  }else{
-		m_scanBufferMax[j] = curX;
-	  }
-      
+	QVector<int>& side = whichSide == 0 ? m_scanBufferMin : m_scanBufferMax;
+	for(long long j = yStart; j < yEnd; j++){
+	  side[j] = (int)curX;
+	  
 	  curX += xStep;
+	  remainder -= remainderStep;
+	  if(remainder < 0){
+		curX++;
+		remainder += D;
+	  }
 	}
 	
   }
   
-  void ScanConvertTriangle(Vertex minYVert, Vertex midYVert, Vertex maxYVert, int handedness){
+  void ScanConvertTriangle(FixedPoint minYVert, FixedPoint midYVert, FixedPoint maxYVert, int handedness){
 	ScanConvertLine(minYVert, maxYVert, handedness);
 	ScanConvertLine(minYVert, midYVert, 1- handedness);
 	ScanConvertLine(midYVert, maxYVert, 1- handedness);
   }
   
   
+  // Fills a triangle given in clip space, both sides of it.
   void FillTriangle(Vertex v1, Vertex v2, Vertex v3){
 	
-	// 3 vertices -- assume sorted order
-	Matrix4f screenSpaceTransform;
-	screenSpaceTransform.InitScreenSpaceTransform(size_.width()/2,size_.height()/2);
-    
-	// Put things into the correct screen space, and then perform the
-	// perspective divide. 
-	Vertex minYVert = v1.Transform(screenSpaceTransform).PerspectiveDivide();	
-	Vertex midYVert = v2.Transform(screenSpaceTransform).PerspectiveDivide();	
-	Vertex maxYVert = v3.Transform(screenSpaceTransform).PerspectiveDivide();	
+	// Put things into the correct screen space. The perspective
+	// divide waits until the triangle is clipped.
+	Vertex a = v1.Transform(screenSpaceTransform_);
+	Vertex b = v2.Transform(screenSpaceTransform_);
+	Vertex c = v3.Transform(screenSpaceTransform_);
+	int codeA = ClipCode(a), codeB = ClipCode(b), codeC = ClipCode(c);
+	
+	// All three corners outside one plane
+	if(codeA & codeB & codeC){
+	  return;
+	}
+	if(codeA | codeB | codeC){
+	  ClipAndFill(a, b, c, codeA | codeB | codeC, false);
+	  return;
+	}
+	FillScreenTriangle(a.PerspectiveDivide(), b.PerspectiveDivide(), c.PerspectiveDivide(), false);
+  }
+
+  // Draws an indexed mesh, every three indices naming the vertices of
+  // one triangle. transform takes the vertices to clip space. Each
+  // vertex is put in screen space once, however many triangles share
+  // it, and triangles facing away from the camera are culled.
+  void FillMesh(const QVector<Vertex>& vertices, const QVector<int>& indices, Matrix4f transform){
+	Matrix4f toScreen = screenSpaceTransform_.Multiply(transform);
+	pixelVertices_.resize(vertices.size());
+	screenVertices_.resize(vertices.size());
+	clipCodes_.resize(vertices.size());
+	for(int i = 0; i < vertices.size(); i++){
+	  Vertex v = vertices[i];
+	  pixelVertices_[i] = v.Transform(toScreen);
+	  clipCodes_[i] = ClipCode(pixelVertices_[i]);
+	  // Only needed, and only safe to divide, inside the clip planes
+	  if(clipCodes_[i] == 0){
+		screenVertices_[i] = pixelVertices_[i].PerspectiveDivide();
+	  }
+	}
+
+	for(int i = 0; i + 2 < indices.size(); i += 3){
+	  int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+	  int codes = clipCodes_[a] | clipCodes_[b] | clipCodes_[c];
+	  if(clipCodes_[a] & clipCodes_[b] & clipCodes_[c]){
+		continue;
+	  }
+	  if(codes){
+		ClipAndFill(pixelVertices_[a], pixelVertices_[b], pixelVertices_[c], codes, true);
+		continue;
+	  }
+	  FillScreenTriangle(screenVertices_[a], screenVertices_[b], screenVertices_[c], true);
+	}
+  }
+
+  QImage image() const {return image_;}
+  void clearImage() {image_.fill(QColor(0,0,0));}
+  void setSize(const QSize& size) { 
+	  size_ = size; 
+	  image_ = QImage(size, QImage::Format_RGB888);
+	  screenSpaceTransform_.InitScreenSpaceTransform(size_.width()/2,size_.height()/2);
+	  // One scan buffer entry per row of the new image
+	  m_scanBufferMin.resize(std::max(size_.height(), 0));
+	  m_scanBufferMax.resize(std::max(size_.height(), 0));
+	  clearImage();
+  }
+
+private:
+  // Planes a triangle is clipped against, in screen space before the
+  // perspective divide: the near plane and the guard band's sides
+  static const int CLIP_PLANES = 5;
+  // A polygon gains at most one corner per plane
+  static const int MAX_CLIP_VERTICES = 3 + CLIP_PLANES;
+
+  // How far v is inside plane, negative when outside
+  float PlaneDistance(Vertex v, int plane) const{
+	switch(plane){
+	  case 0:  return v.GetZ() + v.GetW();                                   // z >= -w
+	  case 1:  return v.GetX() + GUARD_BAND * v.GetW();                      // left
+	  case 2:  return (image_.width() + GUARD_BAND) * v.GetW() - v.GetX();   // right
+	  case 3:  return v.GetY() + GUARD_BAND * v.GetW();                      // top
+	  default: return (image_.height() + GUARD_BAND) * v.GetW() - v.GetY();  // bottom
+	}
+  }
+
+  // One bit per plane v is outside of
+  int ClipCode(Vertex v) const{
+	int code = 0;
+	for(int plane = 0; plane < CLIP_PLANES; plane++){
+	  if(PlaneDistance(v, plane) < 0){
+		code |= 1 << plane;
+	  }
+	}
+	return code;
+  }
+
+  // The point where the edge from inside to outside crosses a plane
+  static Vertex Intersect(Vertex inside, Vertex outside, float insideDistance, float outsideDistance){
+	float t = insideDistance / (insideDistance - outsideDistance);
+	return Vertex(inside.GetX() + t * (outside.GetX() - inside.GetX()),
+	              inside.GetY() + t * (outside.GetY() - inside.GetY()),
+	              inside.GetZ() + t * (outside.GetZ() - inside.GetZ()),
+	              inside.GetW() + t * (outside.GetW() - inside.GetW()));
+  }
+
+  // Clips a triangle in screen space, before the perspective divide,
+  // against the planes set in codes (Sutherland-Hodgman), then fills
+  // what is left as a fan of triangles.
+  void ClipAndFill(Vertex a, Vertex b, Vertex c, int codes, bool cullBackFaces){
+	Vertex polygon[MAX_CLIP_VERTICES];
+	Vertex clipped[MAX_CLIP_VERTICES];
+	polygon[0] = a;
+	polygon[1] = b;
+	polygon[2] = c;
+	int count = 3;
+	for(int plane = 0; plane < CLIP_PLANES && count >= 3; plane++){
+	  if(!(codes & (1 << plane))){
+		continue;
+	  }
+	  int kept = 0;
+	  for(int i = 0; i < count; i++){
+		Vertex& current = polygon[i];
+		Vertex& next = polygon[(i + 1) % count];
+		float currentDistance = PlaneDistance(current, plane);
+		float nextDistance = PlaneDistance(next, plane);
+		if(currentDistance >= 0){
+		  clipped[kept++] = current;
+		}
+		// Always from the inside corner, so the triangle on the other
+		// side of this edge gets exactly the same point
+		if(currentDistance >= 0 && nextDistance < 0){
+		  clipped[kept++] = Intersect(current, next, currentDistance, nextDistance);
+		}
+		else if(currentDistance < 0 && nextDistance >= 0){
+		  clipped[kept++] = Intersect(next, current, nextDistance, currentDistance);
+		}
+	  }
+	  std::copy(clipped, clipped + kept, polygon);
+	  count = kept;
+	}
+	if(count < 3){
+	  return;
+	}
+	for(int i = 0; i < count; i++){
+	  if(polygon[i].GetW() <= 0){
+		return;
+	  }
+	  polygon[i] = polygon[i].PerspectiveDivide();
+	}
+	for(int i = 1; i + 1 < count; i++){
+	  FillScreenTriangle(polygon[0], polygon[i], polygon[i + 1], cullBackFaces);
+	}
+  }
+
+  // Fills a triangle whose vertices are already in screen space.
+  // When culling, those with a negative area (counter-clockwise as
+  // seen on the screen) are skipped.
+  void FillScreenTriangle(Vertex v1, Vertex v2, Vertex v3, bool cullBackFaces){
+	FixedPoint minYVert = ToFixed(v1);
+	FixedPoint midYVert = ToFixed(v2);
+	FixedPoint maxYVert = ToFixed(v3);
+	
+	// Twice the area, in the order given; the sign is that of
+	// Vertex::TriangleArea
+	long long area = Cross(minYVert, midYVert, maxYVert);
+	if(area == 0 || (cullBackFaces && area < 0)){
+	  return;
+	}
     
 	// Sort vertices with 3 swaps
-	if(maxYVert.GetY() < midYVert.GetY()){
-	  Vertex temp = maxYVert;
-	  maxYVert = midYVert;
-	  midYVert = temp;
+	if(maxYVert.y < midYVert.y){
+	  std::swap(maxYVert, midYVert);
 	}       
-	if(midYVert.GetY() < minYVert.GetY()){
-	  Vertex temp = midYVert;
-	  midYVert = minYVert;
-	  minYVert = temp;
+	if(midYVert.y < minYVert.y){
+	  std::swap(midYVert, minYVert);
 	}       
-	if(maxYVert.GetY() < midYVert.GetY()){
-	  Vertex temp = maxYVert;
-	  maxYVert = midYVert;
-	  midYVert = temp;
+	if(maxYVert.y < midYVert.y){
+	  std::swap(maxYVert, midYVert);
 	}       
 	
 	// Compute the area
 	// max then mid or this does not work (why?)
-	float area = minYVert.TriangleArea(maxYVert, midYVert);
-	int handedness = area >= 0 ? 1 : 0; // ternary operator
+	int handedness = Cross(minYVert, maxYVert, midYVert) >= 0 ? 1 : 0; // ternary operator
 	
 	// Draw 3 lines and fill them in.
 	ScanConvertTriangle(minYVert,midYVert,maxYVert,handedness);
-	FillShape(minYVert.GetY(),maxYVert.GetY()); 
+	FillShape((int)FirstRow(minYVert.y), (int)FirstRow(maxYVert.y));
   }
 
-  QImage image() const {return image_;}
-  void clearImage() {image_.fill(QColor(0,0,0));}
-  void setSize(const QSize& size) { 
-	  size_ = size; 
-	  image_ = image_.scaled(size);
-	  clearImage();
+  static FixedPoint ToFixed(Vertex v){
+	FixedPoint p;
+	p.x = std::llround(v.GetX() * SUBPIXEL_ONE);
+	p.y = std::llround(v.GetY() * SUBPIXEL_ONE);
+	return p;
+  }
+
+  // (b - a) x (c - a)
+  static long long Cross(const FixedPoint& a, const FixedPoint& b, const FixedPoint& c){
+	return (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+  }
+
+  // First pixel row whose center is at or below y (28.4)
+  static long long FirstRow(long long y){
+	return CeilDivide(y - SUBPIXEL_ONE / 2, SUBPIXEL_ONE);
+  }
+
+  // Division rounding down, or up, for a of either sign and b > 0
+  static long long FloorDivide(long long a, long long b){
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+  }
+  static long long CeilDivide(long long a, long long b){
+	return -FloorDivide(-a, b);
+  }
+
+  // Writes count pixels of the fill color at dst, 3 bytes (RGB888)
+  // per pixel. Gray colors have three equal bytes and are a single
+  // memset; other colors write the first pixel and then keep copying
+  // what is already written, doubling the span each time.
+  void FillSpan(uchar* dst, int count){
+    const int bytes = count * 3;
+    if(fillColor_[0] == fillColor_[1] && fillColor_[1] == fillColor_[2]){
+      std::memset(dst, fillColor_[0], bytes);
+      return;
+    }
+    std::memcpy(dst, fillColor_, 3);
+    int written = 3;
+    while(written < bytes){
+      int chunk = std::min(written, bytes - written);
+      std::memcpy(dst + written, dst, chunk);
+      written += chunk;
+    }
   }
 
-private:
   QImage image_;
   QSize size_;
+  // Pixel space from clip space, rebuilt only when the size changes
+  Matrix4f screenSpaceTransform_;
+  // FillMesh's vertices in screen space before and after the divide,
+  // and their clip codes, kept to reuse the memory
+  QVector<Vertex> pixelVertices_;
+  QVector<Vertex> screenVertices_;
+  QVector<int> clipCodes_;
   QVector<int> m_scanBufferMin;
   QVector<int> m_scanBufferMax;
+  uchar fillColor_[3];
 };
@@ -5,140 +5,121 @@
 // -O3 to ensure optimizations are
 // applied to this math library
 //
-// Library requires C++17
-#include <cmath> // sqrt
+// This is a thin adapter over the shared MathLib::Vector4f
+// (../MathLib), keeping this lab's accessor style. The arithmetic
+// itself (and its SSE code) lives in MathLib.
+#include <algorithm> // std::max
+#include <cmath> // std::abs
 #include <string> 
+#include "MathLib/Vector4f.h"
 
 class Vector4f{
 public:
 
     // Default Constructor
     // Creates the zero vector
-    Vector4f(){
-        m_x = m_y = m_z = 0.0f;
-        m_w = 1.0f;
+    Vector4f(): m_v(0.0f, 0.0f, 0.0f, 1.0f){
     }
     
     // Initialize all components to one value
-    Vector4f(float value): m_x(value),m_y(value),m_z(value),m_w(value){
+    Vector4f(float value): m_v(value, value, value, value){
 	}
 
 	// Slight shortcut for initializing all componets to one componetn and w to 1.0.
-    Vector4f(float x, float y, float z): m_x(x),m_y(y),m_z(z){
-    	m_w = 1.0f;
+    Vector4f(float x, float y, float z): m_v(x, y, z, 1.0f){
 	}
     // Initialize all components individually
-    Vector4f(float x, float y, float z, float w): m_x(x),m_y(y),m_z(z),m_w(w){
+    Vector4f(float x, float y, float z, float w): m_v(x, y, z, w){
+    }
+
+    // Wrap a vector from the shared library
+    explicit Vector4f(const MathLib::Vector4f& v): m_v(v){
     }
 
     // Vector addition
     Vector4f Add(Vector4f b){
-        return Vector4f(m_x + b.GetX(),
-                        m_y + b.GetY(),
-                        m_z + b.GetZ(),
-						m_w + b.GetW());
+        return Vector4f(m_v + b.m_v);
     }
     // Vector scalar addition
     Vector4f Add(float value){
-        return Vector4f(m_x + value,
-                        m_y + value,
-                        m_z + value,
-						m_w + value);
+        return Vector4f(m_v + MathLib::Vector4f(value, value, value, value));
     }
     // Vector Subtraction 
     Vector4f Sub(Vector4f b){
-        return Vector4f(m_x - b.GetX(),
-                        m_y - b.GetY(),
-                        m_z - b.GetZ(),
-						m_w - b.GetW());
+        return Vector4f(m_v - b.m_v);
     }
     // Vector scalar subtraction
     Vector4f Sub(float value){
-        return Vector4f(m_x - value,
-                        m_y - value,
-                        m_z - value,
-						m_w - value);
+        return Vector4f(m_v - MathLib::Vector4f(value, value, value, value));
     }
     // Vector multiplication
     Vector4f Mul(Vector4f b){
-        return Vector4f(m_x * b.GetX(),
-                        m_y * b.GetY(),
-                        m_z * b.GetZ(),
-						m_w * b.GetW());
+        return Vector4f(m_v.x * b.m_v.x,
+                        m_v.y * b.m_v.y,
+                        m_v.z * b.m_v.z,
+						m_v.w * b.m_v.w);
     }
     // Vector scalar multiplication
     Vector4f Mul(float value){
-        return Vector4f(m_x * value,
-                        m_y * value,
-                        m_z * value,
-						m_w * value);
+        return Vector4f(m_v * value);
     }
     // Vector Division
     Vector4f Div(Vector4f b){
-        return Vector4f(m_x / b.GetX(),
-                        m_y / b.GetY(),
-                        m_z / b.GetZ(),
-						m_w / b.GetW());
+        return Vector4f(m_v.x / b.m_v.x,
+                        m_v.y / b.m_v.y,
+                        m_v.z / b.m_v.z,
+						m_v.w / b.m_v.w);
     }
     // Vector scalar Division
     Vector4f Div(float value){
-        return Vector4f(m_x / value,
-                        m_y / value,
-                        m_z / value,
-						m_w / value);
+        return Vector4f(m_v / value);
     }
     // Get Absolute value of vector
     Vector4f Abs(){
-        return Vector4f(std::abs(m_x), std::abs(m_y), std::abs(m_z), std::abs(m_w));
+        return Vector4f(std::abs(m_v.x), std::abs(m_v.y), std::abs(m_v.z), std::abs(m_v.w));
     }    
 
 
     // Compute the magnitude of a vector (synonymous with 'length')
     float Magnitude(){
-        return (float)sqrt( m_x*m_x + m_y*m_y + m_z*m_z + m_w*m_w);
+        return MathLib::Magnitude(m_v);
     }
 
     // Returns maximum component of vector
     float Max() {
-        return std::max(std::max(m_x,m_y), std::max(m_z,m_w));
+        return std::max(std::max(m_v.x,m_v.y), std::max(m_v.z,m_v.w));
     }
 
     // Compute dot product of 2 vecors
     float Dot(Vector4f b){
-        return  m_x * b.GetX() +
-                m_y * b.GetY() +
-                m_z * b.GetZ() + 
-				m_w * b.GetW();
+        return MathLib::Dot(m_v, b.m_v);
     }
 
     // Compute the cross product
     // Note w component is simply 0
     Vector4f Cross(Vector4f b){
-        float x_ = m_y * b.GetZ() - m_z * b.GetY();
-        float y_ = m_z * b.GetX() - m_x * b.GetZ();
-        float z_ = m_x * b.GetY() - m_y * b.GetX();
-        
-        return Vector4f(x_,y_,z_, 0.0f);
+        MathLib::Vector4f cross = MathLib::CrossProduct(m_v, b.m_v);
+        cross.w = 0.0f;
+        return Vector4f(cross);
     }
 
     // Normalizes our vector
     Vector4f Normalized(){
-        float magnitude = Magnitude();
-        return Vector4f(m_x/magnitude, m_y/magnitude, m_z/magnitude, m_w/magnitude);
+        return Vector4f(MathLib::Normalize(m_v));
     }
 
     std::string ToString(){
-        return "("  + std::to_string(m_x)+","
-                    + std::to_string(m_y)+","
-                    + std::to_string(m_z)+","
-                    + std::to_string(m_w)+")";
+        return "("  + std::to_string(m_v.x)+","
+                    + std::to_string(m_v.y)+","
+                    + std::to_string(m_v.z)+","
+                    + std::to_string(m_v.w)+")";
     }
 
     bool Equals(Vector4f b){
-        if( m_x == b.GetX() &&
-            m_y == b.GetY() &&
-            m_z == b.GetZ() &&
-			m_w == b.GetW()){
+        if( m_v.x == b.GetX() &&
+            m_v.y == b.GetY() &&
+            m_v.z == b.GetZ() &&
+			m_v.w == b.GetW()){
             return true;
         }
         return false;
@@ -146,36 +127,33 @@ public:
 
     // Setters
     void Set(float x, float y, float z){
-        m_x = x;
-        m_y = y;
-        m_z = z;
+        m_v.x = x;
+        m_v.y = y;
+        m_v.z = z;
     }
     
 	void Set(float x, float y, float z, float w){
-        m_x = x;
-        m_y = y;
-        m_z = z;
-		m_w = w;
+        m_v = MathLib::Vector4f(x, y, z, w);
     }
 
     // Getters
-    void SetX(float x) { m_x = x; }
-    void SetY(float y) { m_y = y; }
-   	void SetZ(float z) { m_z = z; }
-    void SetW(float w) { m_w = w; }
+    void SetX(float x) { m_v.x = x; }
+    void SetY(float y) { m_v.y = y; }
+   	void SetZ(float z) { m_v.z = z; }
+    void SetW(float w) { m_v.w = w; }
     
 	// Getters
-    float GetX() { return m_x; }
-    float GetY() { return m_y; }
-    float GetZ() { return m_z; }
-    float GetW() { return m_w; }
+    float GetX() { return m_v.x; }
+    float GetY() { return m_v.y; }
+    float GetZ() { return m_v.z; }
+    float GetW() { return m_v.w; }
+
+    // The shared library's vector, for handing to MathLib functions
+    const MathLib::Vector4f& Get() const { return m_v; }
 
 private:
     // Components of the vector
-    float m_x;
-    float m_y;
-    float m_z;
-    float m_w;
+    MathLib::Vector4f m_v;
 };
 
 #endif
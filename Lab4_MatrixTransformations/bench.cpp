@@ -0,0 +1,143 @@
+/**
+ * Filled triangles per second of ScanBuffer, without a window.
+ *
+ * Fills random triangles of a few sizes at 800x600 and 3840x2160
+ * and prints how many ScanBuffer::FillTriangle draws per second.
+ * Then fills the whole image with two triangles, and compares the
+ * pixels per second that gives with writing every pixel through
+ * QImage::setPixelColor, the way FillShape used to.
+ *
+ * Last it draws objects/monkey.obj turning in front of the camera,
+ * the way BasicWidget does, and prints the frames per second.
+ *
+ * Built by CMake as the 'bench' target; run it from a release build.
+ */
+
+#include <QtCore>
+#include <QtGui>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Mesh.h"
+#include "ScanBuffer.h"
+#include "Vertex.h"
+
+// Triangles already in clip space (w = 1), so FillTriangle only
+// has to put them on the screen
+struct Triangle{
+  Vertex v[3];
+};
+
+// count triangles with corners radius pixels from a random center
+// on a width x height image
+std::vector<Triangle> randomTriangles(int count, float radius, int width, int height){
+  std::vector<Triangle> triangles(count);
+  for(int i = 0; i < count; i++){
+    float cx = 2.0f * std::rand() / RAND_MAX - 1.0f;
+    float cy = 2.0f * std::rand() / RAND_MAX - 1.0f;
+    for(int k = 0; k < 3; k++){
+      float angle = 6.2831853f * std::rand() / RAND_MAX;
+      triangles[i].v[k] = Vertex(cx + std::cos(angle) * radius * 2.0f / width,
+                                 cy + std::sin(angle) * radius * 2.0f / height,
+                                 0.0f, 1.0f);
+    }
+  }
+  return triangles;
+}
+
+// Milliseconds to fill all the triangles, best of a few runs
+double fill(ScanBuffer& buffer, std::vector<Triangle>& triangles){
+  double best = 0;
+  for(int run = 0; run < 5; run++){
+    buffer.clearImage();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < triangles.size(); i++){
+      buffer.FillTriangle(triangles[i].v[0], triangles[i].v[1], triangles[i].v[2]);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    best = run == 0 ? ms : std::min(best, ms);
+  }
+  return best;
+}
+
+int main(int argc, char** argv){
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+
+  const int sizes[2][2] = { {800, 600}, {3840, 2160} };
+  const float radii[3] = { 8.0f, 32.0f, 128.0f };
+
+  std::printf("%-10s %8s %10s %14s\n", "image", "radius", "ms", "triangles/s");
+  for(int s = 0; s < 2; s++){
+    const int width = sizes[s][0], height = sizes[s][1];
+    ScanBuffer buffer(width, height);
+    buffer.setSize(QSize(width, height));
+    for(int r = 0; r < 3; r++){
+      std::srand(1);
+      std::vector<Triangle> triangles = randomTriangles(20000, radii[r], width, height);
+      double ms = fill(buffer, triangles);
+      std::printf("%4dx%-5d %8.0f %10.2f %14.0f\n",
+                  width, height, radii[r], ms, triangles.size() / (ms / 1000.0));
+    }
+  }
+
+  // The whole image, as two triangles and one pixel at a time
+  std::printf("\n%-10s %16s %16s\n", "image", "spans Mpix/s", "per pixel Mpix/s");
+  for(int s = 0; s < 2; s++){
+    const int width = sizes[s][0], height = sizes[s][1];
+    ScanBuffer buffer(width, height);
+    buffer.setSize(QSize(width, height));
+    std::vector<Triangle> screen(2);
+    screen[0].v[0] = Vertex(-1, -1, 0, 1); screen[0].v[1] = Vertex(1, -1, 0, 1); screen[0].v[2] = Vertex(1, 1, 0, 1);
+    screen[1].v[0] = Vertex(-1, -1, 0, 1); screen[1].v[1] = Vertex(1, 1, 0, 1); screen[1].v[2] = Vertex(-1, 1, 0, 1);
+    double spanMs = fill(buffer, screen);
+
+    QImage image(width, height, QImage::Format_RGB888);
+    double pixelMs = 0;
+    for(int run = 0; run < 5; run++){
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for(int j = 0; j < height; j++){
+        for(int i = 0; i < width; i++){
+          image.setPixelColor(i, j, QColor(255, 255, 255));
+        }
+      }
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      pixelMs = run == 0 ? ms : std::min(pixelMs, ms);
+    }
+    const double mpix = (double)width * height / 1e6;
+    std::printf("%4dx%-5d %16.0f %16.0f\n", width, height, mpix / (spanMs / 1000.0), mpix / (pixelMs / 1000.0));
+  }
+
+  // The monkey, one full turn over the frames
+  Mesh mesh;
+  if(!mesh.LoadOBJ("objects/monkey.obj")){
+    std::printf("\nUnable to load objects/monkey.obj\n");
+    return 1;
+  }
+  Vertex center = mesh.Center();
+  Matrix4f projection, translation, rotation, toCenter;
+  projection.InitPerspective(90.0f, 800./600., 0.1f, 1000.0f);
+  translation.InitTranslation(0.0, 0.0, 3.0);
+  toCenter.InitTranslation(-center.GetX(), -center.GetY(), -center.GetZ());
+  std::printf("\n%-10s %10s %10s %10s\n", "image", "triangles", "ms/frame", "frames/s");
+  for(int s = 0; s < 2; s++){
+    const int width = sizes[s][0], height = sizes[s][1];
+    ScanBuffer buffer(width, height);
+    buffer.setSize(QSize(width, height));
+    const int frames = 360;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < frames; frame++){
+      rotation.InitRotation(0.0, 6.2831853f * frame / frames, 0.0);
+      buffer.clearImage();
+      buffer.FillMesh(mesh.vertices(), mesh.indices(), projection.Multiply(translation.Multiply(rotation.Multiply(toCenter))));
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    std::printf("%4dx%-5d %10d %10.2f %10.0f\n", width, height, mesh.triangleCount(), ms, 1000.0 / ms);
+  }
+  return 0;
+}
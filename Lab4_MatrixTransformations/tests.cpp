@@ -0,0 +1,130 @@
+/**
+ * Checks that ScanBuffer fills meshes without cracks or overlaps.
+ *
+ * Each test draws the triangles of a mesh one at a time, counts how
+ * often each pixel is written, and passes when every pixel inside the
+ * mesh's outline is written exactly once and every pixel outside it
+ * never. The meshes are a jittered grid inside the image, the same
+ * grid reaching far past the image, and a ground plane running from
+ * behind the camera out past the guard band, so clipping against the
+ * image, the guard band and the near plane are all covered.
+ *
+ * Built by CMake as the 'tests' target and run by ctest; exits with a
+ * non-zero status if any test fails.
+ */
+
+#include <QtCore>
+#include <QtGui>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Mesh.h"
+#include "ScanBuffer.h"
+#include "Vertex.h"
+
+const int WIDTH = 160;
+const int HEIGHT = 120;
+
+// A cells x cells grid from -size to size in x and y (z = 0), its
+// inner vertices moved up to jitter of a cell at random. Triangles
+// are wound to face a camera looking down +z.
+Mesh grid(int cells, float size, float jitter){
+  Mesh mesh;
+  const float cell = 2.0f * size / cells;
+  for(int j = 0; j <= cells; j++){
+    for(int i = 0; i <= cells; i++){
+      float x = -size + i * cell, y = -size + j * cell;
+      if(i > 0 && i < cells && j > 0 && j < cells){
+        x += jitter * cell * (2.0f * std::rand() / RAND_MAX - 1.0f);
+        y += jitter * cell * (2.0f * std::rand() / RAND_MAX - 1.0f);
+      }
+      mesh.AddVertex(Vertex(x, y, 0.0f));
+    }
+  }
+  for(int j = 0; j < cells; j++){
+    for(int i = 0; i < cells; i++){
+      int v00 = j * (cells + 1) + i, v10 = v00 + 1;
+      int v01 = v00 + cells + 1, v11 = v01 + 1;
+      mesh.AddTriangle(v00, v11, v10);
+      mesh.AddTriangle(v00, v01, v11);
+    }
+  }
+  return mesh;
+}
+
+// Draws the mesh one triangle at a time and checks that the pixels
+// from (left, top) up to (right, bottom) are written once and all
+// others never. Prints how many pixels were written once, more than
+// once, and left as holes or written outside the outline.
+bool coversOnce(const char* name, const Mesh& mesh, Matrix4f transform,
+                int left, int top, int right, int bottom){
+  ScanBuffer buffer(WIDTH, HEIGHT);
+  std::vector<int> writes(WIDTH * HEIGHT, 0);
+  QVector<int> triangle(3);
+  for(int t = 0; t < mesh.triangleCount(); t++){
+    for(int k = 0; k < 3; k++){
+      triangle[k] = mesh.indices()[t * 3 + k];
+    }
+    buffer.clearImage();
+    buffer.FillMesh(mesh.vertices(), triangle, transform);
+    QImage image = buffer.image();
+    for(int j = 0; j < HEIGHT; j++){
+      const uchar* row = image.constScanLine(j);
+      for(int i = 0; i < WIDTH; i++){
+        writes[j * WIDTH + i] += row[i * 3] != 0;
+      }
+    }
+  }
+  int once = 0, twice = 0, holes = 0, outside = 0;
+  for(int j = 0; j < HEIGHT; j++){
+    for(int i = 0; i < WIDTH; i++){
+      const int count = writes[j * WIDTH + i];
+      const bool inside = i >= left && i < right && j >= top && j < bottom;
+      once += count == 1;
+      twice += count > 1;
+      holes += inside && count == 0;
+      outside += !inside && count > 0;
+    }
+  }
+  std::printf("%-20s once %5d, twice %d, holes %d, outside %d\n", name, once, twice, holes, outside);
+  return twice == 0 && holes == 0 && outside == 0;
+}
+
+// The grid's border is not jittered, so it covers the pixels whose
+// centers lie inside x, y in [-0.9, 0.9]
+bool unitTest0(){
+  Matrix4f identity;
+  return coversOnce("grid in the image", grid(24, 0.9f, 0.4f), identity, 8, 6, 152, 114);
+}
+
+bool unitTest1(){
+  Matrix4f identity;
+  return coversOnce("grid past the image", grid(24, 40.0f, 0.4f), identity, 0, 0, WIDTH, HEIGHT);
+}
+
+// A plane one unit below the camera, laid flat and reaching 100000
+// units in every direction: everything below the horizon
+bool unitTest2(){
+  Matrix4f perspective, lift, tilt;
+  perspective.InitPerspective(90.0f, (float)WIDTH / HEIGHT, 0.1f, 1000.0f);
+  lift.InitTranslation(0.0, -1.0, 0.0);
+  tilt.InitRotation(-1.5707963f, 0.0, 0.0);
+  return coversOnce("ground plane", grid(40, 100000.0f, 0.4f), perspective.Multiply(lift.Multiply(tilt)),
+                    0, HEIGHT / 2, WIDTH, HEIGHT);
+}
+
+int main(int argc, char** argv){
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+  std::srand(1);
+
+  bool results[] = { unitTest0(), unitTest1(), unitTest2() };
+  bool passed = true;
+  for(size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++){
+    std::printf("Passed %d: %d\n", (int)i, results[i]);
+    passed = passed && results[i];
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#ifndef MATHLIB_CONSTEXPRMATH_H
+#define MATHLIB_CONSTEXPRMATH_H
+
+#include <cmath>
+
+// MATH_CONSTANT_EVALUATED() is true while the compiler is evaluating
+// a constant expression. Functions use it to pick code that can run
+// at compile time (plain arithmetic, the series below) over code that
+// cannot (SSE intrinsics, the C math library).
+// Compilers without the builtin always take the compile-time path.
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define MATH_CONSTANT_EVALUATED() true
+#endif
+
+// Square root and trigonometry usable in constant expressions.
+// At run time these call the C math library, so results match
+// code that calls it directly. At compile time they are computed
+// in double precision and rounded to float, which agrees with the
+// library to within one unit in the last place.
+namespace ConstMath {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Converts degrees to radians
+constexpr float Radians(float degrees) {
+  return degrees * static_cast<float>(PI / 180.0);
+}
+
+// Newton's method, starting from a guess above the root
+constexpr double SqrtSeries(double x) {
+  if (!(x > 0.0)) return (x == 0.0) ? 0.0 : NAN;
+  double guess = (x > 1.0) ? x : 1.0;
+  for (int i = 0; i < 1100; ++i) {
+    double next = 0.5 * (guess + (x / guess));
+    if (next >= guess) break;
+    guess = next;
+  }
+  return guess;
+}
+
+// Taylor series of sin after reducing t to [-pi, pi]
+constexpr double SinSeries(double t) {
+  const double turns = t / (2.0 * PI);
+  const double whole = static_cast<double>(static_cast<long long>(turns + ((turns < 0.0) ? -0.5 : 0.5)));
+  t -= whole * (2.0 * PI);
+  double term = t;
+  double sum = t;
+  for (int k = 1; k < 16; ++k) {
+    term *= -(t * t) / ((2.0 * k) * ((2.0 * k) + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr float Sqrt(float x) {
+  if (!MATH_CONSTANT_EVALUATED()) return std::sqrt(x);
+  return static_cast<float>(SqrtSeries(x));
+}
+
+constexpr float Sin(float t) {
+  if (!MATH_CONSTANT_EVALUATED()) return static_cast<float>(std::sin(static_cast<double>(t)));
+  return static_cast<float>(SinSeries(t));
+}
+
+constexpr float Cos(float t) {
+  if (!MATH_CONSTANT_EVALUATED()) return static_cast<float>(std::cos(static_cast<double>(t)));
+  return static_cast<float>(SinSeries(t + (PI / 2.0)));
+}
+
+} // namespace ConstMath
+
+#endif
@@ -0,0 +1,588 @@
+// High level design note
+// Our matrix should match the behavior of the glm library.
+#ifndef MATHLIB_MATRIX4F_H
+#define MATHLIB_MATRIX4F_H
+
+#include <cmath>
+#include <cstddef>
+
+// We need to Vector4f header in order to multiply a matrix
+// by a vector.
+#include "Vector4f.h"
+
+namespace MathLib {
+
+// Matrix 4f represents 4x4 matrices in Math
+// Each column is 16-byte aligned so it can be loaded as one SSE
+// register (see MATH_SSE in Vector4f.h).
+// Everything except operator[] (which reinterprets a column as a
+// Vector4f) is constexpr, so fixed matrices can be built at compile
+// time: constexpr Matrix4f R = Matrix4f::MakeRotationY(ConstMath::Radians(30));
+struct Matrix4f {
+private:
+  alignas(16) float n[4][4]; // Store each value of the matrix, column by column
+
+public:
+  Matrix4f() = default;
+
+  // Matrix constructor with 9 scalar values.
+  constexpr Matrix4f(
+    float n00, float n01, float n02, float n03,
+    float n10, float n11, float n12, float n13,
+    float n20, float n21, float n22, float n23,
+    float n30, float n31, float n32, float n33)
+    : n{
+      { n00, n10, n20, n30 },
+      { n01, n11, n21, n31 },
+      { n02, n12, n22, n32 },
+      { n03, n13, n23, n33 } } {
+  }
+
+  // Matrix constructor from four vectors.
+  // Note: 'd' will almost always be 0,0,0,1
+  constexpr Matrix4f(const Vector4f &a, const Vector4f &b, const Vector4f &c, const Vector4f &d)
+    : n{
+      { a.x, b.x, c.x, d.x },
+      { a.y, b.y, c.y, d.y },
+      { a.z, b.z, c.z, d.z },
+      { a.w, b.w, c.w, d.w } } {
+  }
+
+  // Makes the matrix an identity matrix
+  constexpr void identity() {
+    *this = MakeIdentity();
+  }
+
+  // Index operator with two dimensions
+  // Example: M(1,1) returns row 1 and column 1 of matrix M.
+  constexpr float &operator ()(int i, int j) {
+    return (n[j][i]);
+  }
+
+  // Index operator with two dimensions
+  // Example: M(1,1) returns row 1 and column 1 of matrix M.
+  constexpr const float &operator ()(int i, int j) const {
+    return (n[j][i]);
+  }
+
+  // Return a single vector from the matrix.
+  Vector4f &operator [](int j) {
+    return (*reinterpret_cast<Vector4f *>(n[j]));
+  }
+
+  // Return a single vector from the matrix.
+  const Vector4f &operator [](int j) const {
+    return (*reinterpret_cast<const Vector4f *>(n[j]));
+  }
+
+  // Returns column j as a vector (usable in constant expressions)
+  constexpr Vector4f column(int j) const {
+    return Vector4f(n[j][0], n[j][1], n[j][2], n[j][3]);
+  }
+
+  // Builds a transformation matrix.
+  // The rotations use ConstMath::Cos/Sin, which call the C math
+  // library at run time and a series at compile time.
+  static constexpr Matrix4f MakeIdentity() {
+    return Matrix4f(
+      1, 0, 0, 0,
+      0, 1, 0, 0,
+      0, 0, 1, 0,
+      0, 0, 0, 1
+    );
+  }
+  static constexpr Matrix4f MakeRotationX(float t) {
+    return Matrix4f(
+      1, 0, 0, 0,
+      0, ConstMath::Cos(t), ConstMath::Sin(t), 0,
+      0, -ConstMath::Sin(t), ConstMath::Cos(t), 0,
+      0, 0, 0, 1
+    );
+  }
+  static constexpr Matrix4f MakeRotationY(float t) {
+    return Matrix4f(
+      ConstMath::Cos(t), 0, -ConstMath::Sin(t), 0,
+      0, 1, 0, 0,
+      ConstMath::Sin(t), 0, ConstMath::Cos(t), 0,
+      0, 0, 0, 1
+    );
+  }
+  static constexpr Matrix4f MakeRotationZ(float t) {
+    return Matrix4f(
+      ConstMath::Cos(t), ConstMath::Sin(t), 0, 0,
+      -ConstMath::Sin(t), ConstMath::Cos(t), 0, 0,
+      0, 0, 1, 0,
+      0, 0, 0, 1
+    );
+  }
+  static constexpr Matrix4f MakeScale(float sx, float sy, float sz) {
+    return Matrix4f(
+      sx, 0, 0, 0,
+      0, sy, 0, 0,
+      0, 0, sz, 0,
+      0, 0, 0, 1
+    );
+  }
+};
+
+// Swaps the rows and columns of M
+constexpr Matrix4f Transpose(const Matrix4f &M) {
+  return Matrix4f(
+    M(0, 0), M(1, 0), M(2, 0), M(3, 0),
+    M(0, 1), M(1, 1), M(2, 1), M(3, 1),
+    M(0, 2), M(1, 2), M(2, 2), M(3, 2),
+    M(0, 3), M(1, 3), M(2, 3), M(3, 3)
+  );
+}
+
+// Matrix multiplied by a vector
+// Columns are scaled by the components of v and summed as
+// (c0 + c1) + (c2 + c3), the same order as glm.
+constexpr Vector4f operator *(const Matrix4f &M, const Vector4f &v) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    __m128 m = LoadVector(v);
+    __m128 c0 = _mm_mul_ps(LoadVector(M[0]), _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0)));
+    __m128 c1 = _mm_mul_ps(LoadVector(M[1]), _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128 c2 = _mm_mul_ps(LoadVector(M[2]), _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m128 c3 = _mm_mul_ps(LoadVector(M[3]), _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+    return StoreVector(_mm_add_ps(_mm_add_ps(c0, c1), _mm_add_ps(c2, c3)));
+  }
+#endif
+  return Vector4f(
+    ((M(0, 0) * v.x) + (M(0, 1) * v.y)) + ((M(0, 2) * v.z) + (M(0, 3) * v.w)),
+    ((M(1, 0) * v.x) + (M(1, 1) * v.y)) + ((M(1, 2) * v.z) + (M(1, 3) * v.w)),
+    ((M(2, 0) * v.x) + (M(2, 1) * v.y)) + ((M(2, 2) * v.z) + (M(2, 3) * v.w)),
+    ((M(3, 0) * v.x) + (M(3, 1) * v.y)) + ((M(3, 2) * v.z) + (M(3, 3) * v.w))
+  );
+}
+
+// Matrix multiplication (multiply A by B)
+// As before, the products A * B[j] are handed to the four-vector
+// constructor, which lays them out as rows.
+constexpr Matrix4f operator *(const Matrix4f &A, const Matrix4f &B) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    Matrix4f result{};
+    __m128 r0 = LoadVector(A * B[0]);
+    __m128 r1 = LoadVector(A * B[1]);
+    __m128 r2 = LoadVector(A * B[2]);
+    __m128 r3 = LoadVector(A * B[3]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_store_ps(&result[0].x, r0);
+    _mm_store_ps(&result[1].x, r1);
+    _mm_store_ps(&result[2].x, r2);
+    _mm_store_ps(&result[3].x, r3);
+    return result;
+  }
+#endif
+  return Matrix4f(
+    A * B.column(0),
+    A * B.column(1),
+    A * B.column(2),
+    A * B.column(3)
+  );
+}
+
+// The product A * B with the columns A * B[j] kept as columns, as
+// glm and the usual math define it (operator * above lays them out as
+// rows instead). Lab4's Matrix4f::Multiply is built on this.
+constexpr Matrix4f Multiply(const Matrix4f &A, const Matrix4f &B) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    Matrix4f result{};
+    result[0] = A * B[0];
+    result[1] = A * B[1];
+    result[2] = A * B[2];
+    result[3] = A * B[3];
+    return result;
+  }
+#endif
+  return Transpose(A * B);
+}
+
+// Determinant of M, expanded along the 2x2 minors of rows 0-1 and 2-3
+constexpr float Determinant(const Matrix4f &M) {
+  return
+    ((M(0, 0) * M(1, 1)) - (M(1, 0) * M(0, 1))) * ((M(2, 2) * M(3, 3)) - (M(3, 2) * M(2, 3))) -
+    ((M(0, 0) * M(1, 2)) - (M(1, 0) * M(0, 2))) * ((M(2, 1) * M(3, 3)) - (M(3, 1) * M(2, 3))) +
+    ((M(0, 0) * M(1, 3)) - (M(1, 0) * M(0, 3))) * ((M(2, 1) * M(3, 2)) - (M(3, 1) * M(2, 2))) +
+    ((M(0, 1) * M(1, 2)) - (M(1, 1) * M(0, 2))) * ((M(2, 0) * M(3, 3)) - (M(3, 0) * M(2, 3))) -
+    ((M(0, 1) * M(1, 3)) - (M(1, 1) * M(0, 3))) * ((M(2, 0) * M(3, 2)) - (M(3, 0) * M(2, 2))) +
+    ((M(0, 2) * M(1, 3)) - (M(1, 2) * M(0, 3))) * ((M(2, 0) * M(3, 1)) - (M(3, 0) * M(2, 1)));
+}
+
+#ifdef MATH_SSE
+// 2x2 matrices held in one register as (m00, m01, m10, m11), used by
+// the block inverse below. A# is the adjugate of A.
+
+// A * B
+inline __m128 Multiply2x2(__m128 a, __m128 b) {
+  return _mm_add_ps(
+    _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// A# * B
+inline __m128 AdjugateMultiply2x2(__m128 a, __m128 b) {
+  return _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+// A * B#
+inline __m128 MultiplyAdjugate2x2(__m128 a, __m128 b) {
+  return _mm_sub_ps(
+    _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// Cross product of the x, y, z lanes; w comes out as 0 when the
+// inputs are finite
+inline __m128 Cross3(__m128 a, __m128 b) {
+  return _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2))),
+    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+}
+
+// (a.x * b.x + a.y * b.y) + a.z * b.z
+inline float Dot3(__m128 a, __m128 b) {
+  const __m128 p = _mm_mul_ps(a, b);
+  const __m128 xy = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(_mm_add_ss(xy, _mm_movehl_ps(p, p)));
+}
+
+// Inverts M by splitting it into four 2x2 blocks. The columns are
+// treated as the rows of the transpose; since inverse(transpose(M))
+// is transpose(inverse(M)), the rows that come out are the columns
+// of the inverse.
+inline Matrix4f InverseSSE(const Matrix4f &M) {
+  const __m128 c0 = LoadVector(M[0]);
+  const __m128 c1 = LoadVector(M[1]);
+  const __m128 c2 = LoadVector(M[2]);
+  const __m128 c3 = LoadVector(M[3]);
+  const __m128 a = _mm_movelh_ps(c0, c1);
+  const __m128 b = _mm_movehl_ps(c1, c0);
+  const __m128 c = _mm_movelh_ps(c2, c3);
+  const __m128 d = _mm_movehl_ps(c3, c2);
+
+  // |A| |B| |C| |D|
+  const __m128 blockDets = _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+  const __m128 detA = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m128 detB = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(1, 1, 1, 1));
+  const __m128 detC = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(2, 2, 2, 2));
+  const __m128 detD = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(3, 3, 3, 3));
+
+  const __m128 dc = AdjugateMultiply2x2(d, c);
+  const __m128 ab = AdjugateMultiply2x2(a, b);
+  // Adjugates of the four blocks of the inverse, before the divide
+  __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Multiply2x2(b, dc));
+  __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Multiply2x2(c, ab));
+  __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), MultiplyAdjugate2x2(d, ab));
+  __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), MultiplyAdjugate2x2(a, dc));
+
+  // |M| = |A||D| + |B||C| - trace((A# B)(D# C))
+  __m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+  trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+  trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+  const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+  // Dividing by (|M|, -|M|, -|M|, |M|) also applies the adjugate signs
+  const __m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+  x = _mm_mul_ps(x, scale);
+  y = _mm_mul_ps(y, scale);
+  z = _mm_mul_ps(z, scale);
+  w = _mm_mul_ps(w, scale);
+
+  Matrix4f result{};
+  _mm_store_ps(&result[0].x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+  _mm_store_ps(&result[1].x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+  _mm_store_ps(&result[2].x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+  _mm_store_ps(&result[3].x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+  return result;
+}
+#endif
+
+// General inverse of M. A singular M gives infinities or NaNs, as
+// glm::inverse does. Prefer RigidInverse or AffineInverse when the
+// bottom row is known to be 0,0,0,1.
+constexpr Matrix4f Inverse(const Matrix4f &M) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return InverseSSE(M);
+  }
+#endif
+  // 2x2 minors of rows 0-1 (s) and rows 2-3 (c), shared by the cofactors
+  const float s0 = (M(0, 0) * M(1, 1)) - (M(1, 0) * M(0, 1));
+  const float s1 = (M(0, 0) * M(1, 2)) - (M(1, 0) * M(0, 2));
+  const float s2 = (M(0, 0) * M(1, 3)) - (M(1, 0) * M(0, 3));
+  const float s3 = (M(0, 1) * M(1, 2)) - (M(1, 1) * M(0, 2));
+  const float s4 = (M(0, 1) * M(1, 3)) - (M(1, 1) * M(0, 3));
+  const float s5 = (M(0, 2) * M(1, 3)) - (M(1, 2) * M(0, 3));
+  const float c0 = (M(2, 0) * M(3, 1)) - (M(3, 0) * M(2, 1));
+  const float c1 = (M(2, 0) * M(3, 2)) - (M(3, 0) * M(2, 2));
+  const float c2 = (M(2, 0) * M(3, 3)) - (M(3, 0) * M(2, 3));
+  const float c3 = (M(2, 1) * M(3, 2)) - (M(3, 1) * M(2, 2));
+  const float c4 = (M(2, 1) * M(3, 3)) - (M(3, 1) * M(2, 3));
+  const float c5 = (M(2, 2) * M(3, 3)) - (M(3, 2) * M(2, 3));
+  const float s = 1.0f / ((s0 * c5) - (s1 * c4) + (s2 * c3) + (s3 * c2) - (s4 * c1) + (s5 * c0));
+  return Matrix4f(
+    ((M(1, 1) * c5) - (M(1, 2) * c4) + (M(1, 3) * c3)) * s,
+    (-(M(0, 1) * c5) + (M(0, 2) * c4) - (M(0, 3) * c3)) * s,
+    ((M(3, 1) * s5) - (M(3, 2) * s4) + (M(3, 3) * s3)) * s,
+    (-(M(2, 1) * s5) + (M(2, 2) * s4) - (M(2, 3) * s3)) * s,
+
+    (-(M(1, 0) * c5) + (M(1, 2) * c2) - (M(1, 3) * c1)) * s,
+    ((M(0, 0) * c5) - (M(0, 2) * c2) + (M(0, 3) * c1)) * s,
+    (-(M(3, 0) * s5) + (M(3, 2) * s2) - (M(3, 3) * s1)) * s,
+    ((M(2, 0) * s5) - (M(2, 2) * s2) + (M(2, 3) * s1)) * s,
+
+    ((M(1, 0) * c4) - (M(1, 1) * c2) + (M(1, 3) * c0)) * s,
+    (-(M(0, 0) * c4) + (M(0, 1) * c2) - (M(0, 3) * c0)) * s,
+    ((M(3, 0) * s4) - (M(3, 1) * s2) + (M(3, 3) * s0)) * s,
+    (-(M(2, 0) * s4) + (M(2, 1) * s2) - (M(2, 3) * s0)) * s,
+
+    (-(M(1, 0) * c3) + (M(1, 1) * c1) - (M(1, 2) * c0)) * s,
+    ((M(0, 0) * c3) - (M(0, 1) * c1) + (M(0, 2) * c0)) * s,
+    (-(M(3, 0) * s3) + (M(3, 1) * s1) - (M(3, 2) * s0)) * s,
+    ((M(2, 0) * s3) - (M(2, 1) * s1) + (M(2, 2) * s0)) * s
+  );
+}
+
+// Inverse of a rotation plus translation (no scale or shear):
+// the rotation is transposed and the translation rotated back.
+constexpr Matrix4f RigidInverse(const Matrix4f &M) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    __m128 x = LoadVector(M[0]);
+    __m128 y = LoadVector(M[1]);
+    __m128 z = LoadVector(M[2]);
+    __m128 unused = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, unused);
+    const __m128 t = LoadVector(M[3]);
+    __m128 translation = _mm_add_ps(_mm_add_ps(
+      _mm_mul_ps(x, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0))),
+      _mm_mul_ps(y, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)))),
+      _mm_mul_ps(z, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+    translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+    Matrix4f result{};
+    _mm_store_ps(&result[0].x, x);
+    _mm_store_ps(&result[1].x, y);
+    _mm_store_ps(&result[2].x, z);
+    _mm_store_ps(&result[3].x, translation);
+    return result;
+  }
+#endif
+  const float tx = M(0, 3);
+  const float ty = M(1, 3);
+  const float tz = M(2, 3);
+  return Matrix4f(
+    M(0, 0), M(1, 0), M(2, 0), -((M(0, 0) * tx) + (M(1, 0) * ty) + (M(2, 0) * tz)),
+    M(0, 1), M(1, 1), M(2, 1), -((M(0, 1) * tx) + (M(1, 1) * ty) + (M(2, 1) * tz)),
+    M(0, 2), M(1, 2), M(2, 2), -((M(0, 2) * tx) + (M(1, 2) * ty) + (M(2, 2) * tz)),
+    0, 0, 0, 1
+  );
+}
+
+// Inverse of any matrix whose bottom row is 0,0,0,1 (rotation, scale,
+// shear and translation). The upper 3x3 is inverted through cross
+// products of its columns, which are the rows of its adjugate.
+constexpr Matrix4f AffineInverse(const Matrix4f &M) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    const __m128 c0 = LoadVector(M[0]);
+    const __m128 c1 = LoadVector(M[1]);
+    const __m128 c2 = LoadVector(M[2]);
+    __m128 x = Cross3(c1, c2);
+    __m128 y = Cross3(c2, c0);
+    __m128 z = Cross3(c0, c1);
+    const __m128 s = _mm_div_ps(_mm_set1_ps(1.0f), _mm_set1_ps(Dot3(c0, x)));
+    __m128 unused = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, unused);
+    x = _mm_mul_ps(x, s);
+    y = _mm_mul_ps(y, s);
+    z = _mm_mul_ps(z, s);
+    const __m128 t = LoadVector(M[3]);
+    __m128 translation = _mm_add_ps(_mm_add_ps(
+      _mm_mul_ps(x, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0))),
+      _mm_mul_ps(y, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)))),
+      _mm_mul_ps(z, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+    translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+    Matrix4f result{};
+    _mm_store_ps(&result[0].x, x);
+    _mm_store_ps(&result[1].x, y);
+    _mm_store_ps(&result[2].x, z);
+    _mm_store_ps(&result[3].x, translation);
+    return result;
+  }
+#endif
+  const Vector4f r0 = CrossProduct(M.column(1), M.column(2));
+  const Vector4f r1 = CrossProduct(M.column(2), M.column(0));
+  const Vector4f r2 = CrossProduct(M.column(0), M.column(1));
+  const float s = 1.0f / ((M(0, 0) * r0.x) + (M(1, 0) * r0.y) + (M(2, 0) * r0.z));
+  const float tx = M(0, 3);
+  const float ty = M(1, 3);
+  const float tz = M(2, 3);
+  return Matrix4f(
+    r0.x * s, r0.y * s, r0.z * s, -((r0.x * tx) + (r0.y * ty) + (r0.z * tz)) * s,
+    r1.x * s, r1.y * s, r1.z * s, -((r1.x * tx) + (r1.y * ty) + (r1.z * tz)) * s,
+    r2.x * s, r2.y * s, r2.z * s, -((r2.x * tx) + (r2.y * ty) + (r2.z * tz)) * s,
+    0, 0, 0, 1
+  );
+}
+
+// Matrix for transforming normals by M: the inverse transpose of its
+// upper 3x3, so normals stay perpendicular to surfaces under
+// non-uniform scale. The translation row and column are cleared.
+// Compute it once per object and upload it alongside the model matrix
+// rather than calling inverse() in a vertex shader.
+constexpr Matrix4f NormalMatrix(const Matrix4f &M) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    const __m128 c0 = LoadVector(M[0]);
+    const __m128 c1 = LoadVector(M[1]);
+    const __m128 c2 = LoadVector(M[2]);
+    const __m128 x = Cross3(c1, c2);
+    const __m128 s = _mm_div_ps(_mm_set1_ps(1.0f), _mm_set1_ps(Dot3(c0, x)));
+    Matrix4f result{};
+    _mm_store_ps(&result[0].x, _mm_mul_ps(x, s));
+    _mm_store_ps(&result[1].x, _mm_mul_ps(Cross3(c2, c0), s));
+    _mm_store_ps(&result[2].x, _mm_mul_ps(Cross3(c0, c1), s));
+    _mm_store_ps(&result[3].x, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+    return result;
+  }
+#endif
+  const Vector4f r0 = CrossProduct(M.column(1), M.column(2));
+  const Vector4f r1 = CrossProduct(M.column(2), M.column(0));
+  const Vector4f r2 = CrossProduct(M.column(0), M.column(1));
+  const float s = 1.0f / ((M(0, 0) * r0.x) + (M(1, 0) * r0.y) + (M(2, 0) * r0.z));
+  return Matrix4f(
+    r0.x * s, r1.x * s, r2.x * s, 0,
+    r0.y * s, r1.y * s, r2.y * s, 0,
+    r0.z * s, r1.z * s, r2.z * s, 0,
+    0, 0, 0, 1
+  );
+}
+
+// Transforms n points at once: out[i] = M * in[i].
+// The matrix is loaded once and four vertices are transformed per
+// iteration. Results match M * in[i] bit for bit when multiplies and
+// adds are not fused into FMA (the MathLib CMake target turns that
+// off), and to within rounding otherwise; in and out may be the
+// same array.
+inline void TransformPoints(const Matrix4f &M, const Vector4f *in, Vector4f *out, std::size_t n) {
+  std::size_t i = 0;
+#ifdef MATH_SSE
+  const __m128 c0 = LoadVector(M[0]);
+  const __m128 c1 = LoadVector(M[1]);
+  const __m128 c2 = LoadVector(M[2]);
+  const __m128 c3 = LoadVector(M[3]);
+  auto transform = [&](const Vector4f &v) {
+    __m128 m = LoadVector(v);
+    __m128 x = _mm_mul_ps(c0, _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0)));
+    __m128 y = _mm_mul_ps(c1, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128 z = _mm_mul_ps(c2, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m128 w = _mm_mul_ps(c3, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+    return _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+  };
+  const std::size_t blockEnd = n - (n % 4);
+  for (; i < blockEnd; i += 4) {
+    __m128 r0 = transform(in[i]);
+    __m128 r1 = transform(in[i + 1]);
+    __m128 r2 = transform(in[i + 2]);
+    __m128 r3 = transform(in[i + 3]);
+    _mm_store_ps(&out[i].x, r0);
+    _mm_store_ps(&out[i + 1].x, r1);
+    _mm_store_ps(&out[i + 2].x, r2);
+    _mm_store_ps(&out[i + 3].x, r3);
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = M * in[i];
+  }
+}
+
+// Transforms n points stored as separate x, y, z, w arrays
+// (structure of arrays). Eight vertices are transformed per
+// iteration with AVX, four with SSE. Results match
+// M * Vector4f(x[i], y[i], z[i], w[i]) as above; the output arrays
+// may be the input arrays. A null inW means every w is 1.
+inline void TransformPoints(const Matrix4f &M,
+  const float *inX, const float *inY, const float *inZ, const float *inW,
+  float *outX, float *outY, float *outZ, float *outW, std::size_t n) {
+  std::size_t i = 0;
+#ifdef MATH_AVX
+  {
+    __m256 m[4][4];
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < 4; ++col) {
+        m[row][col] = _mm256_set1_ps(M(row, col));
+      }
+    }
+    float *outs[4] = { outX, outY, outZ, outW };
+    for (; i + 8 <= n; i += 8) {
+      __m256 x = _mm256_loadu_ps(inX + i);
+      __m256 y = _mm256_loadu_ps(inY + i);
+      __m256 z = _mm256_loadu_ps(inZ + i);
+      __m256 w = (inW != nullptr) ? _mm256_loadu_ps(inW + i) : _mm256_set1_ps(1.0f);
+      __m256 results[4];
+      for (int row = 0; row < 4; ++row) {
+        __m256 xy = _mm256_add_ps(_mm256_mul_ps(m[row][0], x), _mm256_mul_ps(m[row][1], y));
+        __m256 zw = _mm256_add_ps(_mm256_mul_ps(m[row][2], z), _mm256_mul_ps(m[row][3], w));
+        results[row] = _mm256_add_ps(xy, zw);
+      }
+      for (int row = 0; row < 4; ++row) {
+        _mm256_storeu_ps(outs[row] + i, results[row]);
+      }
+    }
+  }
+#endif
+#ifdef MATH_SSE
+  {
+    __m128 m[4][4];
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < 4; ++col) {
+        m[row][col] = _mm_set1_ps(M(row, col));
+      }
+    }
+    float *outs[4] = { outX, outY, outZ, outW };
+    for (; i + 4 <= n; i += 4) {
+      __m128 x = _mm_loadu_ps(inX + i);
+      __m128 y = _mm_loadu_ps(inY + i);
+      __m128 z = _mm_loadu_ps(inZ + i);
+      __m128 w = (inW != nullptr) ? _mm_loadu_ps(inW + i) : _mm_set1_ps(1.0f);
+      __m128 results[4];
+      for (int row = 0; row < 4; ++row) {
+        __m128 xy = _mm_add_ps(_mm_mul_ps(m[row][0], x), _mm_mul_ps(m[row][1], y));
+        __m128 zw = _mm_add_ps(_mm_mul_ps(m[row][2], z), _mm_mul_ps(m[row][3], w));
+        results[row] = _mm_add_ps(xy, zw);
+      }
+      for (int row = 0; row < 4; ++row) {
+        _mm_storeu_ps(outs[row] + i, results[row]);
+      }
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    Vector4f v = M * Vector4f(inX[i], inY[i], inZ[i], (inW != nullptr) ? inW[i] : 1.0f);
+    outX[i] = v.x;
+    outY[i] = v.y;
+    outZ[i] = v.z;
+    outW[i] = v.w;
+  }
+}
+
+// Transforms n positions stored as separate x, y, z arrays, with w
+// taken to be 1. Writes all four components of each result (w is
+// needed for the perspective divide).
+inline void TransformPoints(const Matrix4f &M,
+  const float *inX, const float *inY, const float *inZ,
+  float *outX, float *outY, float *outZ, float *outW, std::size_t n) {
+  TransformPoints(M, inX, inY, inZ, nullptr, outX, outY, outZ, outW, n);
+}
+
+} // namespace MathLib
+
+#endif
@@ -0,0 +1,194 @@
+// High level design note
+// Our quaternion should match the behavior of glm::quat.
+#ifndef MATHLIB_QUATERNION_H
+#define MATHLIB_QUATERNION_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "Vector4f.h"
+#include "Matrix4f.h"
+
+namespace MathLib {
+
+// A rotation stored as 4 floats instead of the 16 of a Matrix4f.
+// x, y, z are the vector part and w the scalar part, laid out like a
+// Vector4f so the same SSE loads apply. Rotations are composed with *,
+// where a * b rotates by b first and then by a (as with matrices).
+// Products of unit quaternions drift slowly; Normalize() restores them
+// with one square root, where a matrix would need re-orthogonalizing.
+struct alignas(16) Quaternion {
+  float x, y, z, w;
+
+  Quaternion() = default;
+
+  constexpr Quaternion(float a, float b, float c, float d)
+    : x(a), y(b), z(c), w(d) {
+  }
+
+  // The rotation that does nothing
+  static constexpr Quaternion MakeIdentity() {
+    return Quaternion(0, 0, 0, 1);
+  }
+
+  // Rotation by t radians about a unit-length axis (w is ignored).
+  // One sine and one cosine, against six for a rotation matrix.
+  static constexpr Quaternion MakeRotation(const Vector4f &axis, float t) {
+    const float s = ConstMath::Sin(t * 0.5f);
+    return Quaternion(axis.x * s, axis.y * s, axis.z * s, ConstMath::Cos(t * 0.5f));
+  }
+  static constexpr Quaternion MakeRotationX(float t) {
+    return Quaternion(ConstMath::Sin(t * 0.5f), 0, 0, ConstMath::Cos(t * 0.5f));
+  }
+  static constexpr Quaternion MakeRotationY(float t) {
+    return Quaternion(0, ConstMath::Sin(t * 0.5f), 0, ConstMath::Cos(t * 0.5f));
+  }
+  static constexpr Quaternion MakeRotationZ(float t) {
+    return Quaternion(0, 0, ConstMath::Sin(t * 0.5f), ConstMath::Cos(t * 0.5f));
+  }
+
+  // Rotation about x by rx, then y by ry, then z by rz, i.e.
+  // MakeRotationZ(rz) * MakeRotationY(ry) * MakeRotationX(rx).
+  // Expanded so it costs three sines and three cosines in total.
+  static constexpr Quaternion MakeEulerRotation(float rx, float ry, float rz) {
+    const float cx = ConstMath::Cos(rx * 0.5f);
+    const float sx = ConstMath::Sin(rx * 0.5f);
+    const float cy = ConstMath::Cos(ry * 0.5f);
+    const float sy = ConstMath::Sin(ry * 0.5f);
+    const float cz = ConstMath::Cos(rz * 0.5f);
+    const float sz = ConstMath::Sin(rz * 0.5f);
+    return Quaternion(
+      (cz * cy * sx) - (sz * sy * cx),
+      (cz * sy * cx) + (sz * cy * sx),
+      (sz * cy * cx) - (cz * sy * sx),
+      (cz * cy * cx) + (sz * sy * sx)
+    );
+  }
+
+  // Rotation held in the upper 3x3 of M, which must be orthonormal
+  // (no scale or shear). Uses the largest of w, x, y, z to divide by,
+  // which keeps the result accurate for any angle.
+  static constexpr Quaternion MakeFromMatrix(const Matrix4f &M) {
+    const float trace = M(0, 0) + M(1, 1) + M(2, 2);
+    if (trace > 0.0f) {
+      const float s = ConstMath::Sqrt(trace + 1.0f) * 2.0f;
+      return Quaternion((M(2, 1) - M(1, 2)) / s, (M(0, 2) - M(2, 0)) / s, (M(1, 0) - M(0, 1)) / s, 0.25f * s);
+    }
+    if (M(0, 0) > M(1, 1) && M(0, 0) > M(2, 2)) {
+      const float s = ConstMath::Sqrt(1.0f + M(0, 0) - M(1, 1) - M(2, 2)) * 2.0f;
+      return Quaternion(0.25f * s, (M(0, 1) + M(1, 0)) / s, (M(0, 2) + M(2, 0)) / s, (M(2, 1) - M(1, 2)) / s);
+    }
+    if (M(1, 1) > M(2, 2)) {
+      const float s = ConstMath::Sqrt(1.0f + M(1, 1) - M(0, 0) - M(2, 2)) * 2.0f;
+      return Quaternion((M(0, 1) + M(1, 0)) / s, 0.25f * s, (M(1, 2) + M(2, 1)) / s, (M(0, 2) - M(2, 0)) / s);
+    }
+    const float s = ConstMath::Sqrt(1.0f + M(2, 2) - M(0, 0) - M(1, 1)) * 2.0f;
+    return Quaternion((M(0, 2) + M(2, 0)) / s, (M(1, 2) + M(2, 1)) / s, 0.25f * s, (M(1, 0) - M(0, 1)) / s);
+  }
+};
+
+// The four components as a vector, and back, so Vector4f's
+// operations (and their SSE paths) can be reused
+constexpr Vector4f ToVector(const Quaternion &q) {
+  return Vector4f(q.x, q.y, q.z, q.w);
+}
+
+constexpr Quaternion ToQuaternion(const Vector4f &v) {
+  return Quaternion(v.x, v.y, v.z, v.w);
+}
+
+// Composes two rotations: b is applied first, then a.
+// Left scalar: shuffling b into place for SSE cost as much as it saved.
+constexpr Quaternion operator *(const Quaternion &a, const Quaternion &b) {
+  return Quaternion(
+    ((a.w * b.x) + (a.x * b.w)) + ((a.y * b.z) + (a.z * -b.y)),
+    ((a.w * b.y) + (a.x * -b.z)) + ((a.y * b.w) + (a.z * b.x)),
+    ((a.w * b.z) + (a.x * b.y)) + ((a.y * -b.x) + (a.z * b.w)),
+    ((a.w * b.w) + (a.x * -b.x)) + ((a.y * -b.y) + (a.z * -b.z))
+  );
+}
+
+// The opposite rotation, for unit quaternions
+constexpr Quaternion Conjugate(const Quaternion &q) {
+  return Quaternion(-q.x, -q.y, -q.z, q.w);
+}
+
+constexpr float Dot(const Quaternion &a, const Quaternion &b) {
+  return Dot(ToVector(a), ToVector(b));
+}
+
+// Scales q back to unit length
+constexpr Quaternion Normalize(const Quaternion &q) {
+  return ToQuaternion(Normalize(ToVector(q)));
+}
+
+// Normalized linear interpolation from a (t = 0) to b (t = 1) along
+// the shorter path. Cheaper than Slerp, but the angular speed is not
+// constant; fine for small steps such as blending animation frames.
+constexpr Quaternion Nlerp(const Quaternion &a, const Quaternion &b, float t) {
+  const Vector4f to = (Dot(a, b) < 0.0f) ? -ToVector(b) : ToVector(b);
+  return ToQuaternion(Normalize((ToVector(a) * (1.0f - t)) + (to * t)));
+}
+
+// Spherical linear interpolation from a (t = 0) to b (t = 1) along the
+// shorter path, at constant angular speed. Falls back to Nlerp when
+// a and b are nearly equal.
+inline Quaternion Slerp(const Quaternion &a, const Quaternion &b, float t) {
+  float cosAngle = Dot(a, b);
+  Vector4f to = ToVector(b);
+  if (cosAngle < 0.0f) {
+    to = -to;
+    cosAngle = -cosAngle;
+  }
+  if (cosAngle > 0.9995f) {
+    return Nlerp(a, ToQuaternion(to), t);
+  }
+  const float angle = std::acos(cosAngle);
+  const float scale = 1.0f / std::sin(angle);
+  return ToQuaternion(
+    (ToVector(a) * (std::sin((1.0f - t) * angle) * scale)) + (to * (std::sin(t * angle) * scale)));
+}
+
+// Rotation matrix for a unit quaternion, as glm::mat4_cast builds it
+constexpr Matrix4f RotationMatrix(const Quaternion &q) {
+  const float xx = q.x * q.x;
+  const float yy = q.y * q.y;
+  const float zz = q.z * q.z;
+  const float xy = q.x * q.y;
+  const float xz = q.x * q.z;
+  const float yz = q.y * q.z;
+  const float wx = q.w * q.x;
+  const float wy = q.w * q.y;
+  const float wz = q.w * q.z;
+  return Matrix4f(
+    1.0f - (2.0f * (yy + zz)), 2.0f * (xy - wz), 2.0f * (xz + wy), 0,
+    2.0f * (xy + wz), 1.0f - (2.0f * (xx + zz)), 2.0f * (yz - wx), 0,
+    2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - (2.0f * (xx + yy)), 0,
+    0, 0, 0, 1
+  );
+}
+
+// Rotates the x, y, z of v by a unit quaternion; w is kept.
+// Uses v + w * t + u x t with t = 2 (u x v), u being the vector part.
+constexpr Vector4f Rotate(const Quaternion &q, const Vector4f &v) {
+  const float tx = 2.0f * ((q.y * v.z) - (q.z * v.y));
+  const float ty = 2.0f * ((q.z * v.x) - (q.x * v.z));
+  const float tz = 2.0f * ((q.x * v.y) - (q.y * v.x));
+  return Vector4f(
+    v.x + (q.w * tx) + ((q.y * tz) - (q.z * ty)),
+    v.y + (q.w * ty) + ((q.z * tx) - (q.x * tz)),
+    v.z + (q.w * tz) + ((q.x * ty) - (q.y * tx)),
+    v.w
+  );
+}
+
+// Rotates n vectors at once. For more than a couple of vectors it is
+// cheaper to build the matrix once and use TransformPoints than to
+// call Rotate for each one.
+inline void RotateVectors(const Quaternion &q, const Vector4f *in, Vector4f *out, std::size_t n) {
+  TransformPoints(RotationMatrix(q), in, out, n);
+}
+
+} // namespace MathLib
+
+#endif
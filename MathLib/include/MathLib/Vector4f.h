@@ -0,0 +1,284 @@
+#ifndef MATHLIB_VECTOR4F_H
+#define MATHLIB_VECTOR4F_H
+
+// Part of MathLib, the math library shared by the assignments and
+// labs (see MathLib/CMakeLists.txt). The types live in namespace
+// MathLib; each project includes them through its own adapter header
+// with the API it expects.
+
+#include <cmath>
+#include "ConstexprMath.h"
+
+// SSE is used on x86 unless MATH_NO_SIMD is defined, which selects
+// the plain scalar code instead. Both give the same results: the
+// sums are added in the same order glm adds them. Everything is
+// also constexpr; constant expressions always use the scalar code.
+#if !defined(MATH_NO_SIMD) && \
+  (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATH_SSE
+#include <xmmintrin.h>
+#endif
+// AVX (when the compiler targets it) widens the batch transforms
+// in Matrix4f.h to 8 vertices at a time
+#if defined(MATH_SSE) && defined(__AVX__)
+#define MATH_AVX
+#include <immintrin.h>
+#endif
+
+namespace MathLib {
+
+// Vector4f performs vector operations with 4-dimensions
+// The purpose of this class is primarily for 3D graphics
+// applications.
+// Aligned to 16 bytes so x,y,z,w can be loaded as one SSE register.
+struct alignas(16) Vector4f {
+  // Note: x,y,z,w are a convention
+  // x,y,z,w could be position, but also any 4-component value.
+  float x, y, z, w;
+
+  // Default constructor
+  // 'why default?' https://stackoverflow.com/questions/20828907/the-new-keyword-default-in-c11
+  Vector4f() = default;
+
+  // The "Real" constructor we want to use.
+  // This initializes the values x,y,z
+  constexpr Vector4f(float a, float b, float c, float d)
+    : x(a), y(b), z(c), w(d) {
+  }
+
+  // Index operator, allowing us to access the individual
+  // x,y,z,w components of our vector.
+  constexpr float &operator[](int i) {
+    if (MATH_CONSTANT_EVALUATED()) {
+      return (i == 0) ? x : (i == 1) ? y : (i == 2) ? z : w;
+    }
+    return ((&x)[i]);
+  }
+
+  // Index operator, allowing us to access the individual
+  // x,y,z,w components of our vector.
+  constexpr const float &operator[](int i) const {
+    if (MATH_CONSTANT_EVALUATED()) {
+      return (i == 0) ? x : (i == 1) ? y : (i == 2) ? z : w;
+    }
+    return ((&x)[i]);
+  }
+
+  // Multiplication Operator
+  // Multiply vector by a uniform-scalar.
+  constexpr Vector4f &operator *=(float s);
+
+  // Division Operator
+  constexpr Vector4f &operator /=(float s);
+
+  // Addition operator
+  constexpr Vector4f &operator +=(const Vector4f &v);
+
+  // Subtraction operator
+  constexpr Vector4f &operator -=(const Vector4f &v);
+};
+
+#ifdef MATH_SSE
+// Loads a vector into an SSE register
+inline __m128 LoadVector(const Vector4f &v) {
+  return _mm_load_ps(&v.x);
+}
+
+// Stores an SSE register into a new vector
+inline Vector4f StoreVector(__m128 m) {
+  Vector4f v;
+  _mm_store_ps(&v.x, m);
+  return v;
+}
+
+// Adds the four lanes of m as (x + y) + (z + w), the order glm uses
+inline float HorizontalSum(__m128 m) {
+  __m128 pairs = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+}
+#endif
+
+constexpr Vector4f &Vector4f::operator *=(float s) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    _mm_store_ps(&x, _mm_mul_ps(LoadVector(*this), _mm_set1_ps(s)));
+    return (*this);
+  }
+#endif
+  x *= s;
+  y *= s;
+  z *= s;
+  w *= s;
+  return (*this);
+}
+
+constexpr Vector4f &Vector4f::operator /=(float s) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    _mm_store_ps(&x, _mm_div_ps(LoadVector(*this), _mm_set1_ps(s)));
+    return (*this);
+  }
+#endif
+  x /= s;
+  y /= s;
+  z /= s;
+  w /= s;
+  return (*this);
+}
+
+constexpr Vector4f &Vector4f::operator +=(const Vector4f &v) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    _mm_store_ps(&x, _mm_add_ps(LoadVector(*this), LoadVector(v)));
+    return (*this);
+  }
+#endif
+  x += v.x;
+  y += v.y;
+  z += v.z;
+  w += v.w;
+  return (*this);
+}
+
+constexpr Vector4f &Vector4f::operator -=(const Vector4f &v) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    _mm_store_ps(&x, _mm_sub_ps(LoadVector(*this), LoadVector(v)));
+    return (*this);
+  }
+#endif
+  x -= v.x;
+  y -= v.y;
+  z -= v.z;
+  w -= v.w;
+  return (*this);
+}
+
+// Compute the dot product of a Vector4f
+constexpr float Dot(const Vector4f &a, const Vector4f &b) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return HorizontalSum(_mm_mul_ps(LoadVector(a), LoadVector(b)));
+  }
+#endif
+  return ((a.x * b.x) + (a.y * b.y)) + ((a.z * b.z) + (a.w * b.w));
+}
+
+// Multiplication of a vector by a scalar values
+constexpr Vector4f operator *(const Vector4f &v, float s) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return StoreVector(_mm_mul_ps(LoadVector(v), _mm_set1_ps(s)));
+  }
+#endif
+  return Vector4f(
+    v.x * s,
+    v.y * s,
+    v.z * s,
+    v.w * s
+  );
+}
+
+// Division of a vector by a scalar value.
+constexpr Vector4f operator /(const Vector4f &v, float s) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return StoreVector(_mm_div_ps(LoadVector(v), _mm_set1_ps(s)));
+  }
+#endif
+  return Vector4f(
+    v.x / s,
+    v.y / s,
+    v.z / s,
+    v.w / s
+  );
+}
+
+// Negation of a vector
+// Use Case: Sometimes it is handy to apply a force in an opposite direction
+constexpr Vector4f operator -(const Vector4f &v) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return StoreVector(_mm_xor_ps(LoadVector(v), _mm_set1_ps(-0.0f)));
+  }
+#endif
+  return Vector4f(
+    -v.x,
+    -v.y,
+    -v.z,
+    -v.w
+  );
+}
+
+// Return the magnitude of a vector
+constexpr float Magnitude(const Vector4f &v) {
+  return ConstMath::Sqrt(Dot(v, v));
+}
+
+// Add two vectors together
+constexpr Vector4f operator +(const Vector4f &a, const Vector4f &b) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return StoreVector(_mm_add_ps(LoadVector(a), LoadVector(b)));
+  }
+#endif
+  return Vector4f(
+    a.x + b.x,
+    a.y + b.y,
+    a.z + b.z,
+    a.w + b.w
+  );
+}
+
+// Subtract two vectors
+constexpr Vector4f operator -(const Vector4f &a, const Vector4f &b) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    return StoreVector(_mm_sub_ps(LoadVector(a), LoadVector(b)));
+  }
+#endif
+  return Vector4f(
+    a.x - b.x,
+    a.y - b.y,
+    a.z - b.z,
+    a.w - b.w
+  );
+}
+
+// Vector Projection
+// Note: This is the vector projection of 'a' onto 'b'
+constexpr Vector4f Project(const Vector4f &a, const Vector4f &b) {
+  float magB = Magnitude(b);
+  return b * (Dot(a, b) / (magB * magB));
+}
+
+// Set a vectors magnitude to 1
+// Note: This is NOT generating a normal vector
+constexpr Vector4f Normalize(const Vector4f &v) {
+#ifdef MATH_SSE
+  if (!MATH_CONSTANT_EVALUATED()) {
+    __m128 m = LoadVector(v);
+    __m128 magnitude = _mm_sqrt_ps(_mm_set1_ps(HorizontalSum(_mm_mul_ps(m, m))));
+    return StoreVector(_mm_div_ps(m, magnitude));
+  }
+#endif
+  return v / Magnitude(v);
+}
+
+// a x b (read: 'a crossed b')
+// Produces a new vector perpendicular to a and b.
+// (So long as a and b are not parallel which returns zero vector)
+// Note: For a Vector4f, we can only compute a cross product to 
+//       to vectors in 3-dimensions. Simply ignore w, and set to (0,0,0,1)
+//       for this vector.
+constexpr Vector4f CrossProduct(const Vector4f &a, const Vector4f &b) {
+  return Vector4f(
+    (a.y * b.z) - (a.z * b.y),
+    (a.z * b.x) - (a.x * b.z),
+    (a.x * b.y) - (a.y * b.x),
+    1);
+}
+
+} // namespace MathLib
+
+#endif